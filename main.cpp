@@ -2,1032 +2,1760 @@
 // This code is licensed under the MIT License.
 // For details, visit: https://opensource.org/licenses/MIT
 
-#include <iostream>
-#include <iomanip>
-#include <memory>
-#include <stdexcept>
-#include <string>
-#include <sstream>
-#include <vector>
-#include <algorithm>
-#include <functional>
-#include <random>
-#include <limits>
-#include <map>
-#include <set>
-#include <utility>
-#include <cmath>
-
-class Board;
-class Player;
-
-struct TextColor {
-    static const std::string DEFAULT;
-    static const std::string CYAN;
+#define TIC_TAC_TOE_IMPLEMENTATION
+//Only the game itself replaces the global allocator, to count its allocations.
+#define TIC_TAC_TOE_ALLOCATION_COUNTER
+#include "tic-tac-toe.hpp"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <csignal>
+#endif
+
+//The program around the engine, which isn't part of the library.
+namespace tic_tac_toe {
+
+struct BenchmarkOptions {
+    //Only cases whose name contains it are measured, every case when it's empty.
+    std::string filter = "";
+    //Each case is repeated until at least this long is spent on it.
+    std::chrono::milliseconds minTime = std::chrono::milliseconds(100);
 };
 
-struct ConnectedCell {
-    int row;
-    int column;
-    int verticalChain;
-    int horizontalChain;
-    int diagonalLeftChain;
-    int diagonalRightChain;
-    int totalConnected;
-};
-
-class Screen : public std::enable_shared_from_this<Screen> {
+/**
+ * Times hot paths of boards and bots, so they can be compared between builds to catch regressions.
+ * Every case is measured on Frenzy grids from 3 up to 256 with 2 up to 16 bots, each starting 
+ * from a partly marked board and bots that are seeded the same way on every run.
+ */
+class Benchmark {
 public:
-    enum RetainedTextKey { 
-        MAIN_MENU, 
-        GAME_MODE_HEADER, 
-        SELECTED_CELL_HISTORY
+    Benchmark(BenchmarkOptions options);
+
+    void run();
+
+    std::string resultText() const;
+
+private:
+    struct Fixture {
+        std::shared_ptr<Screen> screen;
+        //Never changed once it's marked, every case works on their own copy of it.
+        std::unique_ptr<Board> board;
     };
 
-    std::map<RetainedTextKey, std::string>& retainedText() const;
+    struct Result {
+        std::string name;
+        long totalIterations;
+        std::chrono::steady_clock::duration elapsedTime;
+    };
+
+    static constexpr uint64_t SEED = 1;
+    static constexpr std::array<int, 5> GRID_SIZES { 3, 8, 32, 128, 256 };
+    static constexpr std::array<int, 3> TOTAL_PLAYERS { 2, 4, 16 };
+    //Part of the grid marked before measuring, so there are chains to find and cells left to mark.
+    static constexpr double MARKED_RATIO = 0.4;
+
+    const BenchmarkOptions _options;
+    std::vector<Result> _results;
+    //Written with the outcome of every iteration, so the measured work isn't optimized away.
+    volatile int _sink = 0;
 
-    std::unique_ptr<Board> const& board() const;
+    static Fixture _createFixture(int gridSize, int totalPlayers);
+
+    /**
+     * Run given work with a doubling amount of iterations, until it takes at least the min time.
+     * Skipped when its name doesn't match the filter.
+     */
+    void _measure(std::string const& name, std::function<void(long totalIterations)> const& work);
+};
 
-    void setBoard(std::unique_ptr<Board> board);
+/**
+ * Plays games from a script without prompting or rendering anything, where each line is a game of:
+ *    mode ('classic' or 'frenzy'), grid size only for Frenzy mode, total players, 
+ *    marker of each player and the cell number of each move.
+ * For example `frenzy 5 3 X O Z 12 6 0` or `classic 2 X O 4 0 8`, anything after '#' is ignored.
+ * Player one always goes first, and turns go around the same way they do when played.
+ */
+class ScriptRunner {
+public:
+    /**
+     * Every played game is written into the record writer, unless it's null.
+     */
+    ScriptRunner(std::shared_ptr<GameRecordWriter> recordWriter = nullptr);
 
-    std::unique_ptr<Board> requireGameMode();
+    /**
+     * Whole script from given file, or from the standard input when it's "-".
+     */
+    static std::string readScript(std::string const& path);
 
-    std::vector<std::shared_ptr<Player>> requirePlayers();
+    /**
+     * Play every game of given script, appending a line of result for each of them into `results`.
+     * Games are reported by the line they're on, and invalid ones are skipped with the reason.
+     */
+    void run(std::string_view script, std::string& results);
 
-    int requireGridSize();
+    /**
+     * Move past the next token of given line, returning false when there's none left.
+     */
+    static bool nextToken(std::string_view& line, std::string_view& token);
 
-    void clear();
+    static bool parseNumber(std::string_view token, int minValue, int maxValue, int& number);
 
 private:
-    mutable std::map<RetainedTextKey, std::string> _retainedText {};
-    std::unique_ptr<Board> _board = nullptr;
+    const std::shared_ptr<Screen> _screen;
+    const std::shared_ptr<GameRecordWriter> _recordWriter;
+    //Mode, grid size and markers of the current board, which is reused by games with the same setup.
+    bool _isFrenzy = false;
+    int _gridSize = 0;
+    std::string _markers {};
+    //Markers of the game being read, reused by every line so reading them doesn't allocate.
+    std::string _lineMarkers {};
+
+    /**
+     * Play a single game from given line without its comment, throws when it's invalid.
+     */
+    void _playLine(std::string_view line, std::string& results);
+
+    void _prepareBoard(bool isFrenzy, int gridSize);
 };
 
-class Player {
+/**
+ * Hosts games for clients over TCP on a single event loop, where each connection is a session 
+ * owning its own board and players. Bot moves are searched by a pool of compute threads,
+ * so a slow search never holds up reading or writing the other sessions.
+ *
+ * Clients and the server exchange lines of text, in place of prompts and renders of the screen.
+ * Clients send any of:
+ *    new <classic|frenzy> [grid size, only for frenzy] <marker> <human|bot>...
+ *    move <cell number>, for the human player whose turn it is.
+ *    rematch, to start over with the same players.
+ *    undo, to take back the latest human move along with the bot moves after it, until the game is over.
+ *    save, to receive the game as hex of a game record, which a server resumes from even after restarting.
+ *    resume <hex of a game record>
+ *    board, to receive the whole state of the game again.
+ *    quit
+ * And the server answers with:
+ *    players <marker>:<human|bot>..., ordered by player number.
+ *    grid <grid size> <player number who marked each cell, or zero>...
+ *    moved <player number> <cell number> <gained points>
+ *    score <score of each player>...
+ *    turn <player number>, where bots then move on their own.
+ *    over <draw|won> [player number]
+ *    saved <hex of a game record>
+ *    error <reason>
+ *
+ * Each bot allocates its own transposition table of `SESSION_TABLE_MEGABYTES` on its first search,
+ * or twice that for Monte Carlo tree search as it keeps a spare node pool to reroot into,
+ * unless '--table-mb' or '--mcts-mb' are given.
+ * Tables aren't shared between sessions, since boards of other grids and players hash the same.
+ * So a session with a single bot on the biggest grid takes about 1.5 MB once it's searched.
+ * Only available on Linux, as it waits on epoll.
+ */
+class GameServer {
 public:
-    Player(std::shared_ptr<Screen> const screen, int number, std::string marker);
+    //Keeps the grid line of each session reasonably short.
+    static constexpr int MAX_GRID_SIZE = 64;
+    //Connections sending a longer line than this are closed.
+    static constexpr size_t MAX_LINE_LENGTH = 4096;
+    //Sessions stop reading once this much output is waiting on a client that doesn't read it,
+    //until it's sent, so a client flooding requests can't grow the output without bounds.
+    static constexpr size_t MAX_PENDING_OUTPUT = 64 * 1024;
+    //Transposition table or node pools of each bot, kept far smaller than for simulations 
+    //as every session has its own bots.
+    static constexpr size_t SESSION_TABLE_MEGABYTES = 1;
 
-    virtual ~Player() = default;
+    /**
+     * Every finished game is written into the record writer, unless it's null.
+     */
+    GameServer(
+        int port, 
+        int totalComputeThreads, 
+        SearchOptions searchOptions, 
+        std::shared_ptr<GameRecordWriter> recordWriter = nullptr);
 
-    virtual std::string name();
+    GameServer(GameServer const&) = delete;
 
-    virtual int requireCellSelection();
+    GameServer& operator=(GameServer const&) = delete;
 
-    const int& number() const;
+    ~GameServer();
 
-    const std::string& marker() const;
+    /**
+     * Serve clients until the process is interrupted or terminated, throws when the port can't be listened on.
+     * Waits for them through epoll in place of their default handling, so it returns once they're received.
+     */
+    void run();
+
+private:
+    struct Session {
+        int socket;
+        std::shared_ptr<Screen> screen;
+        //Received text which hasn't made a whole line yet.
+        std::string input {};
+        //Text yet to be sent, once the socket is writable again.
+        std::string output {};
+        //Whether the board is being searched by a compute thread, so it's left untouched until then.
+        bool isBotThinking = false;
+        //Closed sessions can still be referenced by a bot move that's being searched.
+        bool isClosed = false;
+        bool isQuitting = false;
+        //Whether the client is done sending, where the lines it sent before are still played.
+        bool isInputEnded = false;
+        //Board before each move of a human player, sharing the moves they have in common.
+        std::vector<BoardSnapshot> undoSnapshots {};
+    };
 
-    const int& score() const;
+    struct BotMove {
+        std::shared_ptr<Session> session;
+        int cellNumber;
+    };
 
-    void setScore(int score);
+    const int _port;
+    const int _totalComputeThreads;
+    const SearchOptions _searchOptions;
+    const std::shared_ptr<GameRecordWriter> _recordWriter;
+    int _listenSocket = -1;
+    int _epoll = -1;
+    //Signaled by compute threads whenever a bot move is found.
+    int _botMoveEvent = -1;
+    //Readable once the process is interrupted or terminated.
+    int _signalEvent = -1;
+    //Spare descriptor given up to turn away connections once the process runs out of them.
+    int _reserveDescriptor = -1;
+    //Whether the listening socket is left out of epoll, since there's no descriptor left to turn them away.
+    bool _isAcceptPaused = false;
+    std::unordered_map<int, std::shared_ptr<Session>> _sessions {};
+    std::vector<std::thread> _computeThreads {};
+    std::mutex _mutex;
+    std::condition_variable _botTurnCondition;
+    std::deque<std::shared_ptr<Session>> _botTurns {};
+    std::vector<BotMove> _botMoves {};
+    bool _isStopping = false;
+
+    void _listen();
+
+    void _accept();
 
-    const int& lastScore() const;
+    /**
+     * Accept the pending connection with the reserve descriptor and close it right away,
+     * so it doesn't stay pending and wake epoll over and over. Once the reserve can't be taken back,
+     * the listening socket is left out of epoll until a session closes.
+     */
+    void _rejectConnection();
 
-    void reset();
+    /**
+     * Read and handle lines until the socket has nothing left, or the session stops reading.
+     */
+    void _receive(std::shared_ptr<Session> const& session);
 
-protected:
-    std::weak_ptr<Screen> const _screen;
-    const int _number;
-    const std::string _marker;
-    int _score = 0;
-    int _lastScore = 0;
-};
+    /**
+     * Handle every whole line received so far, stopping early once the session quits or stops reading.
+     */
+    void _handleLines(std::shared_ptr<Session> const& session);
 
-class Bot : public Player {
-public:
-    Bot(std::shared_ptr<Screen> const screen, int number, std::string marker);
+    /**
+     * Whether the session takes more lines, which it doesn't while too much output is waiting to be sent.
+     */
+    static bool _isReceiving(Session const& session);
 
-    std::string name() override;
+    /**
+     * Send as much output as the socket takes, waiting for it to be writable for the rest.
+     * Lines put off while the output was full are handled once there's room for it again.
+     */
+    void _send(Session& session);
 
-    int requireCellSelection() override;
+    void _close(std::shared_ptr<Session> const& session);
 
-private:
-    std::vector<ConnectedCell> _rankAvailableCells(
-        Player const& player, 
-        std::set<int> const& availableCellNumbers);
+    void _handleLine(std::shared_ptr<Session> const& session, std::string_view line);
+
+    void _startGame(std::shared_ptr<Session> const& session, std::string_view arguments);
+
+    void _resumeGame(std::shared_ptr<Session> const& session, std::string_view arguments);
+
+    /**
+     * Mark the cell for the player whose turn it is, recording the game once this move is over it.
+     */
+    void _markCell(std::shared_ptr<Session> const& session, int cellNumber);
+
+    /**
+     * Tell whose turn it is or how the game is over, handing the turn to a compute thread for bots.
+     */
+    void _announceTurn(std::shared_ptr<Session> const& session);
 
     /**
-     * Compute which one from two have shortest turn distance from this bot.
-     * Assuming we compares second and fourth player,
-     *    { p1, p2, bot, p4, p5 }
-     * The one have shortest turn distance from this bot is fourth player,
-     * with second player have longest turn.
+     * Players, grid and score of the game.
      */
-    Player const& _compareNextTurn(Player const& player1, Player const& player2);
+    void _appendStateText(Session& session) const;
+
+    /**
+     * Whose turn it is, or how the game is over.
+     */
+    void _appendStatusText(Session& session) const;
+
+    void _searchBotTurns();
+
+    void _applyBotMoves();
 };
 
-class Board {
+struct CommandLineOptions {
+    enum Mode {
+        PLAY,
+        SIMULATE,
+        REPLAY,
+        SCRIPT,
+        SERVE,
+        BENCHMARK,
+        BUILD_BOOK
+    };
+
+    Mode mode = Mode::PLAY;
+    //Finished games are appended into it when given, whether they're played or simulated.
+    std::shared_ptr<GameRecordWriter> recordWriter = nullptr;
+    SimulationOptions simulationOptions {};
+    std::string replayPath = "";
+    size_t replayGameIndex = 0;
+    //Every move of the game is replayed, or built into a book, when it's not limited.
+    size_t totalReplayMoves = std::numeric_limits<size_t>::max();
+    std::string bookPath = "";
+    //Game record an opening book is built from.
+    std::string bookRecordPath = "";
+    std::string scriptPath = "";
+    int serverPort = 0;
+    BenchmarkOptions benchmarkOptions {};
+    //Where to export instrumented metrics as JSON, only when built with instrumentation.
+    std::string metricsPath = "";
+};
+
+class CommandLine {
 public:
-    Board(
-        std::shared_ptr<Screen> const screen, 
-        const std::vector<std::shared_ptr<Player>> players, 
-        int gridSize);
+    static const std::string usageText();
 
-    virtual ~Board() = default;
+    /**
+     * Read options from command line arguments, excluding the program name.
+     * The game is played interactively without argument, otherwise throws when any of them is invalid.
+     */
+    static void parse(std::vector<std::string> const& arguments, CommandLineOptions& options);
 
-    virtual bool isCompleted() = 0;
+    /**
+     * Text of the game from given record file, as it was after given amount of moves.
+     */
+    static std::string replayText(CommandLineOptions const& options);
 
-    const std::vector<std::shared_ptr<Player>>& players() const;
+    /**
+     * Build an opening book from the record and save it, returning what's been built.
+     */
+    static std::string buildBook(CommandLineOptions const& options);
+};
 
-    const std::shared_ptr<Player>& playerTurn() const;
+Benchmark::Benchmark(BenchmarkOptions options) : _options(options) {}
+
+void Benchmark::run() {
+    for (int gridSize : Benchmark::GRID_SIZES) {
+        for (int totalPlayers : Benchmark::TOTAL_PLAYERS) {
+            const Fixture fixture = Benchmark::_createFixture(gridSize, totalPlayers);
+            const Board& board = *fixture.board;
+            const std::unique_ptr<Board> workBoard = board.clone();
+            Board& work = *workBoard;
+            Bot& bot = static_cast<Bot&>(*board.players().at(0));
+            const std::string suffix = "/grid:" + std::to_string(gridSize) + "/players:" + std::to_string(totalPlayers);
+
+            this->_measure("findConnectedCell" + suffix, [this, &board, &totalPlayers](long totalIterations) {
+                const int totalCells = board.gridSize() * board.gridSize();
+
+                for (long i = 0; i < totalIterations; i++) {
+                    const int cell = i % totalCells;
+                    this->_sink = board.findConnectedCell(
+                        board.rowByCellNumber(cell), 
+                        board.columnByCellNumber(cell), 
+                        i % totalPlayers + 1).totalConnected;
+                }
+            });
 
-    int columnByCellNumber(int cellNumber);
+            //Replaced rescanning the grid for available cells, as they're now kept up to date by moves.
+            this->_measure("findChainMap" + suffix, [this, &board, &totalPlayers](long totalIterations) {
+                ChainMap chainMap {};
 
-    int rowByCellNumber(int cellNumber);
+                for (long i = 0; i < totalIterations; i++) {
+                    board.findChainMap(i % totalPlayers + 1, chainMap);
+                    this->_sink = chainMap.vertical[0];
+                }
+            });
 
-    int cellNumberByPosition(int row, int column);
+            //Marks the remaining cells in turns, copying the fixture back once the grid is full.
+            this->_measure("markCellByNumber" + suffix, [this, &board, &work](long totalIterations) {
+                work.copyFrom(board);
 
-    std::set<int> findAvailableCellNumbers();
+                for (long i = 0; i < totalIterations; i++) {
+                    if (work.isCompleted()) work.copyFrom(board);
 
-    ConnectedCell findConnectedCell(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+                    const int cellNumber = work.availableCellNumber(i % work.totalAvailableCells());
+                    this->_sink = work.markCellByNumber(cellNumber, work.playerTurn()->number());
+                    work.togglePlayerTurn();
+                }
+            });
 
-    std::string scoreText();
+            this->_measure("applyMove+undoMove" + suffix, [this, &board, &work, &totalPlayers](long totalIterations) {
+                work.copyFrom(board);
 
-    std::string gridLayoutText();
+                for (long i = 0; i < totalIterations; i++) {
+                    const int cellNumber = work.availableCellNumber(i % work.totalAvailableCells());
+                    this->_sink = work.applyMove(cellNumber, i % totalPlayers + 1);
+                    work.undoMove();
+                }
+            });
 
-    std::string playerTurnText();
+            //Copying drops the rendered layout, so each iteration renders the whole grid.
+            this->_measure("gridLayoutText" + suffix, [this, &board, &work](long totalIterations) {
+                for (long i = 0; i < totalIterations; i++) {
+                    work.copyFrom(board);
+                    this->_sink = work.gridLayoutText().size();
+                }
+            });
 
-    std::string resultText();
+            this->_measure("Bot::_rankAvailableCells" + suffix, [this, &board, &bot](long totalIterations) {
+                std::vector<int> availableCells {};
+                std::vector<ConnectedCell> rankedCells {};
 
-    bool markCellByNumber(int cellNumber, std::string marker);
+                board.readAvailableCellNumbers(availableCells);
 
-    void reset();
+                for (long i = 0; i < totalIterations; i++) {
+                    bot._rankAvailableCells(board, bot, availableCells, rankedCells);
+                    this->_sink = rankedCells.at(0).totalConnected;
+                }
+            });
 
-    void togglePlayerTurn();
+            this->_measure("PatternEvaluator::rankCells" + suffix, [this, &board](long totalIterations) {
+                const PatternEvaluator evaluator {};
+                const std::unique_ptr<Board> patternBoard = board.clone();
+                std::vector<int> availableCells {};
+                std::vector<ConnectedCell> rankedCells {};
 
-    int requireGridSelection();
+                patternBoard->keepWindows();
+                patternBoard->readAvailableCellNumbers(availableCells);
 
-    bool requireRematch();
+                for (long i = 0; i < totalIterations; i++) {
+                    evaluator.rankCells(*patternBoard, 1, availableCells, rankedCells);
+                    this->_sink = rankedCells.at(0).score;
+                }
+            });
 
-protected:
-    std::weak_ptr<Screen> const _screen;
-    const std::vector<std::shared_ptr<Player>> _players;
-    const int _gridSize;
-    std::vector<std::vector<std::string>> _grid;
-    std::shared_ptr<Player> _playerTurn = nullptr;
+            //Whole turns played out by the bots, which keep their tables between turns as they do in a game.
+            this->_measure("Bot::requireCellSelection" + suffix, [this, &board, &work](long totalIterations) {
+                work.copyFrom(board);
 
-    int _countChainByDirection(
-        int row, 
-        int column, 
-        int deltaRow, 
-        int deltaColumn,
-        std::string targetMarker,
-        int maxChain);
+                for (long i = 0; i < totalIterations; i++) {
+                    if (work.isCompleted()) work.copyFrom(board);
 
-    int _countCurrentTopChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+                    const std::shared_ptr<Player>& player = work.playerTurn();
+                    const int cell = player->requireCellSelection(work);
 
-    int _countCurrentBottomChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+                    work.markCellByNumber(cell, player->number());
+                    work.togglePlayerTurn();
+                    this->_sink = cell;
+                }
+            });
+        }
+    }
+}
 
-    int _countCurrentLeftChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+std::string Benchmark::resultText() const {
+    std::ostringstream text;
+    text << std::left << std::setw(48) << "Case" << std::right << std::setw(14) << "Time/op" 
+        << std::setw(14) << "Iterations" << "\n";
 
-    int _countCurrentRightChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+    for (const Result& result : this->_results) {
+        const double nanoseconds = std::chrono::duration<double, std::nano>(result.elapsedTime).count() 
+            / result.totalIterations;
+        std::ostringstream time;
 
-    int _countTopLeftChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+        time << std::fixed << std::setprecision(1);
+        if (nanoseconds >= 1e6) time << nanoseconds / 1e6 << " ms";
+        else if (nanoseconds >= 1e3) time << nanoseconds / 1e3 << " us";
+        else time << nanoseconds << " ns";
 
-    int _countTopRightChain(
-        int row,
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+        text << std::left << std::setw(48) << result.name << std::right << std::setw(14) << time.str() 
+            << std::setw(14) << result.totalIterations << "\n";
+    }
 
-    int _countBottomLeftChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
+    return text.str();
+}
 
-    int _countBottomRightChain(
-        int row, 
-        int column, 
-        std::string targetMarker,
-        int maxChain = std::numeric_limits<int>::max());
-};
+Benchmark::Fixture Benchmark::_createFixture(int gridSize, int totalPlayers) {
+    Fixture fixture {};
+    std::vector<std::shared_ptr<Player>> bots {};
 
-class ClassicBoard : public Board {
-public:
-    ClassicBoard(
-        std::shared_ptr<Screen> const screen, 
-        const std::vector<std::shared_ptr<Player>> players);
+    fixture.screen = std::make_shared<Screen>();
 
-    static const std::string nameAndDescription();
+    for (int number = 1; number <= totalPlayers; number++) {
+        SearchOptions searchOptions {};
+        //Seeded so they only stop at the depth, which is kept low enough for the biggest grids.
+        searchOptions.seed = Benchmark::SEED;
+        searchOptions.maxDepth = 3;
 
-    bool isCompleted() override;
-};
+        const std::string marker(1, static_cast<char>('!' + (number - 1) % ('~' - '!' + 1)));
+        bots.push_back(std::make_shared<Bot>(number, marker, searchOptions));
+    }
 
-class FrenzyBoard : public Board {
-public:
-    FrenzyBoard(
-        std::shared_ptr<Screen> const screen, 
-        const std::vector<std::shared_ptr<Player>> players, 
-        int gridSize);
+    fixture.board = std::make_unique<FrenzyBoard>(fixture.screen, bots, gridSize);
 
-    static const std::string nameAndDescription();
+    std::vector<int> cells(gridSize * gridSize);
+    Board& board = *fixture.board;
 
-    bool isCompleted() override;
-};
+    //Bots draw from the board, which every case copies along with the rest of the fixture.
+    board.seed(Benchmark::SEED);
+    std::iota(cells.begin(), cells.end(), 0);
 
-const std::string TextColor::DEFAULT = "\033[0m";
+    //Shuffled by hand, as the standard shuffle differs between platforms.
+    for (size_t i = cells.size(); i > 1; i--) std::swap(cells[i - 1], cells[board.random().below(i)]);
 
-const std::string TextColor::CYAN = "\033[96m";
+    cells.resize(static_cast<size_t>(cells.size() * Benchmark::MARKED_RATIO));
+    board.setPlayerTurn(1);
 
-std::map<Screen::RetainedTextKey, std::string>& Screen::retainedText() const { return this->_retainedText; }
+    for (int cell : cells) {
+        board.markCellByNumber(cell, board.playerTurn()->number());
+        board.togglePlayerTurn();
+    }
 
-std::unique_ptr<Board> const& Screen::board() const { return this->_board; }
+    return fixture;
+}
 
-void Screen::setBoard(std::unique_ptr<Board> board) { this->_board = std::move(board); }
+void Benchmark::_measure(std::string const& name, std::function<void(long totalIterations)> const& work) {
+    if (name.find(this->_options.filter) == std::string::npos) return;
 
-std::unique_ptr<Board> Screen::requireGameMode() {
-    this->_retainedText[RetainedTextKey::MAIN_MENU] = 
-        "Tic-Tac-Toe\n"
-        "-----------\n"
-        "1. Classic\n"
-        "2. Frenzy\n";
-    std::unique_ptr<Board> board;
-    int gameMode = -1;
+    for (long totalIterations = 1; ; totalIterations *= 2) {
+        const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        work(totalIterations);
+        const std::chrono::steady_clock::duration elapsedTime = std::chrono::steady_clock::now() - startTime;
 
-    this->clear();
-    std::cout << this->_retainedText[RetainedTextKey::MAIN_MENU] << "\n";
+        if (elapsedTime >= this->_options.minTime) {
+            this->_results.push_back(Result { name, totalIterations, elapsedTime });
+            return;
+        }
+    }
+}
 
-    while (true) {
-        std::string line;
-        
-        std::cout << "Select game mode: ";
-        std::getline(std::cin, line);
-        std::cout << "\n";
-
-        std::stringstream lineStream(line);
-
-        if (lineStream >> gameMode 
-            && lineStream.eof()
-            && gameMode >= 1
-            && gameMode <= 2) {
-            switch (gameMode) {
-                case 1: {
-                    this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] = 
-                        ClassicBoard::nameAndDescription();
-                    const std::vector<std::shared_ptr<Player>> players = this->requirePlayers();
-                    board = std::make_unique<ClassicBoard>(shared_from_this(), players);
-                    break;
-                }
+ScriptRunner::ScriptRunner(std::shared_ptr<GameRecordWriter> recordWriter) :
+    _screen(std::make_shared<Screen>()),
+    _recordWriter(recordWriter) {
+}
 
-                case 2: {
-                    this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] = 
-                        FrenzyBoard::nameAndDescription();
-                    const int gridSize = this->requireGridSize();
-                    const std::vector<std::shared_ptr<Player>> players = this->requirePlayers(); 
-                    board = std::make_unique<FrenzyBoard>(shared_from_this(), players, gridSize);
-                    break;
-                }       	
-            }
+std::string ScriptRunner::readScript(std::string const& path) {
+    if (path == "-") return std::string(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
 
-            break;
-        }
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Can't open script '" + path + "'.");
+
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
 
-        gameMode = -1;
-        this->clear();
+void ScriptRunner::run(std::string_view script, std::string& results) {
+    size_t lineNumber = 0;
+
+    while (!script.empty()) {
+        const size_t lineEnd = std::min(script.find('\n'), script.size());
+        std::string_view line = script.substr(0, lineEnd);
+        script.remove_prefix(std::min(lineEnd + 1, script.size()));
+        lineNumber++;
+
+        line = line.substr(0, std::min(line.find('#'), line.size()));
+        std::string_view remainingLine = line;
+        std::string_view token;
+        //Blank lines and comments aren't games.
+        if (!ScriptRunner::nextToken(remainingLine, token)) continue;
+
+        results += "line " + std::to_string(lineNumber) + ": ";
+
+        try {
+            this->_playLine(line, results);
+        } catch (std::runtime_error const& error) {
+            results += "invalid, ";
+            results += error.what();
+        }
 
-        std::cout << this->_retainedText[RetainedTextKey::MAIN_MENU]  
-            << "\n** Invalid game mode, please reselect!\n";
+        results += '\n';
     }
 
-    board->togglePlayerTurn();
-    return board;
+    if (this->_recordWriter != nullptr) this->_recordWriter->flush();
 }
 
-std::vector<std::shared_ptr<Player>> Screen::requirePlayers() {
-    std::vector<std::shared_ptr<Player>> players {};
+bool ScriptRunner::nextToken(std::string_view& line, std::string_view& token) {
+    const size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string_view::npos) return false;
 
-    this->clear();
-    std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n";
+    const size_t end = std::min(line.find_first_of(" \t\r", start), line.size());
+    token = line.substr(start, end - start);
+    line.remove_prefix(end);
 
-    while (true) {
-        std::string line;
+    return true;
+}
 
-        //Requiring for number of players.
-        std::cout << "Input number of players (min 2): ";
-        std::getline(std::cin, line);
+bool ScriptRunner::parseNumber(std::string_view token, int minValue, int maxValue, int& number) {
+    const std::from_chars_result result = std::from_chars(token.data(), token.data() + token.size(), number);
 
-        this->clear();
-        std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER];
+    return result.ec == std::errc() 
+        && result.ptr == token.data() + token.size()
+        && number >= minValue
+        && number <= maxValue;
+}
 
-        int totalPlayers = 0;
-        std::stringstream lineStream(line);
+void ScriptRunner::_playLine(std::string_view line, std::string& results) {
+    std::string_view token;
+    int gridSize = 0;
+    int totalPlayers = 0;
 
-        if (!(lineStream >> totalPlayers) || !lineStream.eof() || totalPlayers < 2) {   
-            std::cout << "\n** Invalid number of players, please reinput!\n";
-            continue;
+    ScriptRunner::nextToken(line, token);
+    if (token != "classic" && token != "frenzy") throw std::runtime_error("expected 'classic' or 'frenzy'");
+
+    const bool isFrenzy = token == "frenzy";
+
+    //Capped the same as the server, as the board of a much bigger grid can't even be allocated.
+    if (isFrenzy && (!ScriptRunner::nextToken(line, token) 
+        || !ScriptRunner::parseNumber(token, 3, GameServer::MAX_GRID_SIZE, gridSize))) {
+        throw std::runtime_error("expected grid size between 3 and " + std::to_string(GameServer::MAX_GRID_SIZE));
+    }
+
+    //Each cell stores the player number within a single byte.
+    if (!ScriptRunner::nextToken(line, token) 
+        || !ScriptRunner::parseNumber(token, 2, std::numeric_limits<uint8_t>::max(), totalPlayers)) {
+        throw std::runtime_error("expected number of players between 2 and 255");
+    }
+
+    this->_lineMarkers.clear();
+
+    for (int i = 0; i < totalPlayers; i++) {
+        if (!ScriptRunner::nextToken(line, token) 
+            || token.size() != 1 
+            || this->_lineMarkers.find(token[0]) != std::string::npos) {
+            throw std::runtime_error("expected a unique single character marker of player-" + std::to_string(i + 1));
         }
 
-        const std::function<std::string()> readyPlayersText = [&players, &totalPlayers]() {
-            std::ostringstream text;
-            std::ostringstream readyPlayersText;
+        this->_lineMarkers += token[0];
+    }
 
-            for (const std::shared_ptr<Player>& player : players) {
-                readyPlayersText << player->name() << "-" << player->number()
-                    << " (" << player->marker() << ") is ready!\n";
-            }
+    this->_prepareBoard(isFrenzy, isFrenzy ? gridSize : totalPlayers + 1);
 
-            const std::string readyPlayers = readyPlayersText.str().empty() 
-                ? "" 
-                : "\n" + readyPlayersText.str();
-            text << players.size() << "/" << totalPlayers << " Players are set.\n" << readyPlayers;
+    const std::unique_ptr<Board>& board = this->_screen->board();
+    int cellNumber = 0;
 
-            return text.str();
-        };
-        const std::function<std::string()> setupPlayerNumberText = [&players]() {
-            return "\nSetting up player-" + std::to_string(players.size() + 1) + "...\n";
-        };
-        std::set<std::string> usedMarkers {};
+    while (ScriptRunner::nextToken(line, token)) {
+        if (board->isCompleted()) throw std::runtime_error("game is already over before '" + std::string(token) + "'");
 
-        std::cout << "\n" << readyPlayersText() << setupPlayerNumberText();
+        if (!ScriptRunner::parseNumber(token, 0, std::numeric_limits<int>::max(), cellNumber) 
+            || !board->isCellAvailable(cellNumber)) {
+            throw std::runtime_error("invalid move '" + std::string(token) + "'");
+        }
 
-        while (true) {
-            //Requiring for player's unique marker.
-            std::cout << "Marker: (1 char) ";
-            std::getline(std::cin, line);
+        board->markCellByNumber(cellNumber, board->playerTurn()->number());
+        board->togglePlayerTurn();
+    }
 
-            this->clear();
-            std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER]
-                << "\n" << readyPlayersText() << setupPlayerNumberText();
+    if (this->_recordWriter != nullptr) this->_recordWriter->write(*board);
 
-            lineStream.clear();
-            lineStream.str(line);
+    const std::shared_ptr<Player> winner = board->winner();
 
-            if (line.length() != 1 //Only allow single character.
-                || usedMarkers.find(line) != usedMarkers.end()) { //Disallow using same marker.
-                std::cout << "\n** Invalid marker, please reinput!\n";
-                continue;
-            }
+    if (!board->isCompleted()) results += "unfinished";
+    else if (winner == nullptr) results += "draw";
+    else results.append(winner->marker()).append(" won");
 
-            const std::string marker = line;
-            usedMarkers.insert(marker);
+    results += ", scores";
 
-            std::cout << "Marker: " << marker << "\n";
+    for (const std::shared_ptr<Player>& player : board->players()) {
+        results += ' ';
+        results += std::to_string(board->score(player->number()));
+    }
+}
 
-            while (true) {
-                //Requiring for player's type, whether bot or human.
-                std::cout << "As a bot? (y/n): ";
-                std::getline(std::cin, line);
+void ScriptRunner::_prepareBoard(bool isFrenzy, int gridSize) {
+    const std::unique_ptr<Board>& board = this->_screen->board();
 
-                this->clear();
-                std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] 
-                    << "\n" << readyPlayersText() << setupPlayerNumberText() << "Marker: " << marker << "\n";
+    if (board == nullptr 
+        || this->_isFrenzy != isFrenzy 
+        || this->_gridSize != gridSize 
+        || this->_markers != this->_lineMarkers) {
+        std::vector<std::shared_ptr<Player>> players {};
 
-                for (char& ch : line) ch = std::tolower(ch);
+        for (size_t i = 0; i < this->_lineMarkers.size(); i++) {
+            players.push_back(std::make_shared<Player>(i + 1, std::string(1, this->_lineMarkers[i])));
+        }
 
-                std::shared_ptr<Player> player;
+        if (isFrenzy) this->_screen->setBoard(std::make_unique<FrenzyBoard>(this->_screen, players, gridSize));
+        else this->_screen->setBoard(ClassicBoard::create(this->_screen, players));
 
-                if (line == "y" || line == "yes") {
-                    player = std::make_shared<Bot>(shared_from_this(), players.size() + 1, marker);
+        this->_isFrenzy = isFrenzy;
+        this->_gridSize = gridSize;
+        this->_markers = this->_lineMarkers;
+    }
 
-                } else if (line == "n" || line == "no") {
-                    player = std::make_shared<Player>(shared_from_this(), players.size() + 1, marker);
+    board->reset();
+    board->setPlayerTurn(1);
+}
 
-                } else {
-                    std::cout << "\n** Invalid player option, please reselect!\n";                 
-                    continue;
-                }
+GameServer::GameServer(
+    int port, 
+    int totalComputeThreads, 
+    SearchOptions searchOptions, 
+    std::shared_ptr<GameRecordWriter> recordWriter) :
+    _port(port),
+    _totalComputeThreads(std::max(1, totalComputeThreads)),
+    _searchOptions(searchOptions),
+    _recordWriter(recordWriter) {
+}
+
+GameServer::~GameServer() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_isStopping = true;
+    }
+
+    this->_botTurnCondition.notify_all();
+    for (std::thread& thread : this->_computeThreads) thread.join();
+
+#if defined(__linux__)
+    for (const std::pair<const int, std::shared_ptr<Session>>& session : this->_sessions) ::close(session.first);
+    if (this->_listenSocket >= 0) ::close(this->_listenSocket);
+    if (this->_epoll >= 0) ::close(this->_epoll);
+    if (this->_botMoveEvent >= 0) ::close(this->_botMoveEvent);
+    if (this->_signalEvent >= 0) ::close(this->_signalEvent);
+    if (this->_reserveDescriptor >= 0) ::close(this->_reserveDescriptor);
+#endif
+}
+
+#if defined(__linux__)
 
-                players.push_back(player);
-                break;
+void GameServer::run() {
+    this->_listen();
+
+    for (int i = 0; i < this->_totalComputeThreads; i++) {
+        this->_computeThreads.emplace_back(&GameServer::_searchBotTurns, this);
+    }
+
+    std::cout << "Serving on port " << this->_port << " with " << this->_totalComputeThreads 
+        << " compute threads." << std::endl;
+
+    std::array<epoll_event, 64> events {};
+
+    while (true) {
+        const int totalEvents = ::epoll_wait(this->_epoll, events.data(), events.size(), -1);
+
+        if (totalEvents < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Can't wait for the server events.");
+        }
+
+        for (int i = 0; i < totalEvents; i++) {
+            const int socket = events[i].data.fd;
+
+            if (socket == this->_listenSocket) {
+                this->_accept();
+                continue;
+
+            } else if (socket == this->_botMoveEvent) {
+                this->_applyBotMoves();
+                continue;
+
+            } else if (socket == this->_signalEvent) {
+                std::cout << "Stopped serving." << std::endl;
+                return;
             }
 
-            this->clear();
-            std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n" << readyPlayersText();
+            const std::unordered_map<int, std::shared_ptr<Session>>::iterator session = this->_sessions.find(socket);
+            if (session == this->_sessions.end()) continue;
 
-            //Keep looping until every player has been created.
-            if (players.size() == totalPlayers) break;
+            //Held on, as the session is removed from the map once it's closed.
+            const std::shared_ptr<Session> heldSession = session->second;
 
-            std::cout << setupPlayerNumberText();
+            if ((events[i].events & EPOLLIN) != 0) this->_receive(heldSession);
+
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0) this->_close(heldSession);
+            else if (!heldSession->isClosed) this->_send(*heldSession);
         }
+    }
+}
 
-        std::cout << "\nInput anything to start...";
-        std::getline(std::cin, line);
-        std::cout << "\n";
-        break;
+void GameServer::_listen() {
+    this->_listenSocket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (this->_listenSocket < 0) throw std::runtime_error("Can't open the server socket.");
+
+    const int isReused = 1;
+    ::setsockopt(this->_listenSocket, SOL_SOCKET, SO_REUSEADDR, &isReused, sizeof(isReused));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(this->_port));
+
+    if (::bind(this->_listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(this->_listenSocket, SOMAXCONN) != 0) {
+        throw std::runtime_error("Can't listen on port " + std::to_string(this->_port) + ".");
     }
 
-    return players;
-}
+    this->_epoll = ::epoll_create1(0);
+    this->_botMoveEvent = ::eventfd(0, EFD_NONBLOCK);
+    this->_reserveDescriptor = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
 
-int Screen::requireGridSize() {
-    int gridSize = 0;
+    //Blocked before any compute thread is started, so they inherit it and the signals only reach epoll.
+    sigset_t signals {};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    this->_signalEvent = ::signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
 
-    this->clear();
-    std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n";
+    if (this->_epoll < 0 || this->_botMoveEvent < 0 || this->_signalEvent < 0 || this->_reserveDescriptor < 0) {
+        throw std::runtime_error("Can't set up the server events.");
+    }
 
+    for (const int socket : {this->_listenSocket, this->_botMoveEvent, this->_signalEvent}) {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = socket;
+        ::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, socket, &event);
+    }
+}
+
+void GameServer::_accept() {
     while (true) {
-        std::string line;
-        std::cout << "Input grid size (min 3): ";
-        std::getline(std::cin, line);
-        std::cout << "\n";
+        const int socket = ::accept4(this->_listenSocket, nullptr, nullptr, SOCK_NONBLOCK);
 
-        std::stringstream lineStream(line);
+        if (socket < 0 && (errno == EINTR || errno == ECONNABORTED)) continue;
 
-        if (lineStream >> gridSize && lineStream.eof() && gridSize >= 3) break;
+        if (socket < 0 && (errno == EMFILE || errno == ENFILE)) {
+            this->_rejectConnection();
+            return;
+        }
 
-        gridSize = 0;
-        this->clear();
+        if (socket < 0) return;
 
-        std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] 
-            << "\n** Invalid grid size, please reinput!\n";
-    }  
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = socket;
 
-    return gridSize;
-}
+        if (::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, socket, &event) != 0) {
+            ::close(socket);
+            continue;
+        }
 
-void Screen::clear() { std::cout << "\033[H\033[2J\033[3J"; }
+        const std::shared_ptr<Session> session = std::make_shared<Session>();
+        session->socket = socket;
+        session->screen = std::make_shared<Screen>();
+        session->output = "hello tic-tac-toe\n";
 
-Player::Player(std::shared_ptr<Screen> const screen, int number, std::string marker) : 
-    _screen(screen),
-    _number(number),
-    _marker(marker) {
+        this->_sessions[socket] = session;
+        this->_send(*session);
+    }
 }
 
-std::string Player::name() { return "Player"; }
+void GameServer::_rejectConnection() {
+    std::cerr << "Out of file descriptors, turning away a connection." << std::endl;
 
-int Player::requireCellSelection() {
-    const std::shared_ptr<Screen> screen = this->_screen.lock();
-    if (screen == nullptr) throw std::runtime_error("Weak pointer expired.");
+    if (this->_reserveDescriptor >= 0) {
+        ::close(this->_reserveDescriptor);
+        const int socket = ::accept4(this->_listenSocket, nullptr, nullptr, SOCK_NONBLOCK);
+        if (socket >= 0) ::close(socket);
+        this->_reserveDescriptor = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
 
-    return screen->board()->requireGridSelection(); 
+    if (this->_reserveDescriptor < 0) {
+        std::cerr << "No descriptor left to turn them away, pausing new connections." << std::endl;
+        ::epoll_ctl(this->_epoll, EPOLL_CTL_DEL, this->_listenSocket, nullptr);
+        this->_isAcceptPaused = true;
+    }
 }
 
-const int& Player::number() const { return this->_number; }
+void GameServer::_receive(std::shared_ptr<Session> const& session) {
+    char buffer[4096];
+
+    //Handled after each read, so the input doesn't pile up once the session stops reading.
+    while (GameServer::_isReceiving(*session)) {
+        const ssize_t totalReceived = ::recv(session->socket, buffer, sizeof(buffer), 0);
+
+        if (totalReceived == 0) {
+            session->isInputEnded = true;
+            this->_handleLines(session);
+            break;
+        }
 
-const std::string& Player::marker() const { return this->_marker; }
+        if (totalReceived < 0 && errno == EINTR) continue;
+        if (totalReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
 
-const int& Player::score() const { return this->_score; }
+        if (totalReceived < 0) {
+            this->_close(session);
+            return;
+        }
 
-void Player::setScore(int score) { 
-    this->_lastScore = this->_score;
-    this->_score = score;
+        session->input.append(buffer, totalReceived);
+        this->_handleLines(session);
+    }
 }
 
-const int& Player::lastScore() const { return this->_lastScore; }
+void GameServer::_handleLines(std::shared_ptr<Session> const& session) {
+    size_t lineStart = 0;
+    size_t lineEnd = session->input.find('\n');
+
+    for (; lineEnd != std::string::npos && GameServer::_isReceiving(*session); 
+        lineEnd = session->input.find('\n', lineStart)) {
+        this->_handleLine(session, std::string_view(session->input).substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+    }
+
+    session->input.erase(0, lineStart);
+
+    //Anything after quitting is dropped, while lines put off by a full output are kept.
+    if (session->isQuitting || lineEnd != std::string::npos) return;
 
-void Player::reset() {
-    this->_score = 0;
-    this->_lastScore = 0;
+    if (session->isInputEnded) {
+        session->isQuitting = true;
+    } else if (session->input.size() > GameServer::MAX_LINE_LENGTH) {
+        session->output += "error line is too long\n";
+        session->isQuitting = true;
+    }
 }
 
-Bot::Bot(std::shared_ptr<Screen> const screen, int number, std::string marker) : 
-    Player(screen, number, marker) {
+bool GameServer::_isReceiving(Session const& session) {
+    return !session.isQuitting && session.output.size() < GameServer::MAX_PENDING_OUTPUT;
 }
 
-std::string Bot::name() { return "Bot"; }
-
-int Bot::requireCellSelection() {
-    const std::shared_ptr<Screen> screen = this->_screen.lock();
-    if (screen == nullptr) throw std::runtime_error("Weak pointer expired.");
-
-    const int totalPlayers = screen->board()->players().size();
-    const std::set<int>& availableCells = screen->board()->findAvailableCellNumbers();
-    const std::vector<ConnectedCell>& rankedCells = this->_rankAvailableCells(*this, availableCells);
-    std::vector<ConnectedCell> playerToBlockCells {};
-    std::shared_ptr<const Player> playerToBlock = nullptr;
-    
-    //Searching player to block.
-    //Iterate from the next player turn — right side in the array — from this bot, 
-    //up until latest player turn — left side in the array —, whilist ignoring this bot index.
-    //This bot index same as this bot number - 1.
-    for (int n = this->_number % totalPlayers, i = n;
-        n < totalPlayers + this->_number % totalPlayers && i != this->_number - 1;
-        n++, i = n % totalPlayers) {
-        const std::shared_ptr<const Player>& player = screen->board()->players().at(i);
-        const std::vector<ConnectedCell>& playerCells = this->_rankAvailableCells(*player, availableCells);   
-        const Player& playerShortestNextTurn = playerToBlock == nullptr
-            ? *player
-            : this->_compareNextTurn(*playerToBlock, *player);
-            
-        if (playerToBlockCells.empty()
-            //Replace targeted player when the new one have more cell to connect.
-            || playerCells.at(0).totalConnected > playerToBlockCells.at(0).totalConnected
-            //Prioritize to block player with shortest turn distance from this bot.
-            || (playerCells.at(0).totalConnected == playerToBlockCells.at(0).totalConnected
-                && &playerShortestNextTurn == &*player)) {
-            playerToBlockCells = playerCells;
-            playerToBlock = player;
-        }
-    }
-    
-    std::unique_ptr<const ConnectedCell> bestCell = rankedCells.at(0).totalConnected >= 3
-        ? std::make_unique<ConnectedCell>(rankedCells.at(0))
-        : nullptr;
-     
-    //Looking whether it's necessary to block.
-    for (const ConnectedCell& playerCell : playerToBlockCells) {
-        //No need to block when they have nothing to connect.
-        if (playerCell.totalConnected == 0) break;
-        
-        //Immediately block when the amount of connected cell is bigger than this bot.
-        if (playerCell.totalConnected > rankedCells.at(0).totalConnected) {
-            bestCell = std::make_unique<ConnectedCell>(playerCell);
-            break;
-        } 
-        
-        bool isBestCellFound = false;
-        
-        //When the targeted player has an equal maximum amount of cell to connect.
-        //Try to find a cell that's not only can block them but also create a new chain.
-        //If can't be found, just block any cell with the same total connected cell.
-        //
-        //Assume this bot ranked cells : { 11, 12, 13, ... }
-        //Targeted player ranked cells : { 16, 17, 18, 13, ... }
-        //If they all have the same total connected cell. That's means 13 is the best cell,
-        //not only for this bot to make a chain, but also effectively block them.
-        for (const ConnectedCell& rankedCell : rankedCells) {
-            if (playerCell.totalConnected == rankedCells.at(0).totalConnected 
-                && playerCell.totalConnected == rankedCell.totalConnected) {
-                bestCell = std::make_unique<ConnectedCell>(playerCell);
-                const bool isSamePosition = playerCell.row == rankedCell.row 
-                    && playerCell.column == rankedCell.column;
-
-                //Keep iterating until we find it.
-                if (isSamePosition) isBestCellFound = true;
-                else continue;
-            }
-            
-            break;
+void GameServer::_send(Session& session) {
+    while (true) {
+        size_t totalSent = 0;
+
+        while (totalSent < session.output.size()) {
+            const ssize_t sent = ::send(
+                session.socket, 
+                session.output.data() + totalSent, 
+                session.output.size() - totalSent, 
+                MSG_NOSIGNAL);
+
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) break;
+
+            totalSent += sent;
         }
-        
-        if (isBestCellFound) break;
+
+        session.output.erase(0, totalSent);
+
+        //Each round handles at least a line, as there's room for its output.
+        if (!GameServer::_isReceiving(session) || session.input.find('\n') == std::string::npos) break;
+
+        this->_handleLines(this->_sessions.at(session.socket));
     }
-    
-    //Found the best cell.
-    if (bestCell != nullptr) {
-        return screen->board()->cellNumberByPosition(bestCell->row, bestCell->column);
-
-    //There's atleast a cell to chain.
-    } else if (rankedCells.at(0).verticalChain >= 1
-        || rankedCells.at(0).horizontalChain >= 1
-        || rankedCells.at(0).diagonalLeftChain >= 1
-        || rankedCells.at(0).diagonalRightChain >= 1) {
-        return screen->board()->cellNumberByPosition(rankedCells.at(0).row, rankedCells.at(0).column);
+
+    if (session.output.empty() && session.isQuitting) {
+        this->_close(this->_sessions.at(session.socket));
+        return;
     }
 
-    const std::vector<int> availableCellsArray(availableCells.begin(), availableCells.end());
-    std::default_random_engine engine(std::random_device{}());
-    std::uniform_int_distribution<int> randomIndex(
-        0, 
-        std::max(0, static_cast<int>(availableCells.size()) - 1)
-    );
+    //Only wait for the socket to be writable while there's something left to send,
+    //and for it to be readable while the session takes more lines, as it's always readable once it's ended.
+    const bool isReadable = GameServer::_isReceiving(session) && !session.isInputEnded;
+    epoll_event event {};
+    event.events = (isReadable ? static_cast<uint32_t>(EPOLLIN) : static_cast<uint32_t>(0))
+        | (session.output.empty() ? static_cast<uint32_t>(0) : static_cast<uint32_t>(EPOLLOUT));
+    event.data.fd = session.socket;
+    ::epoll_ctl(this->_epoll, EPOLL_CTL_MOD, session.socket, &event);
+}
+
+void GameServer::_close(std::shared_ptr<Session> const& session) {
+    if (session->isClosed) return;
+
+    session->isClosed = true;
+    ::epoll_ctl(this->_epoll, EPOLL_CTL_DEL, session->socket, nullptr);
+    ::close(session->socket);
+    this->_sessions.erase(session->socket);
 
-    //Pick randomly when there's nothing to chain.
-    return availableCellsArray.at(randomIndex(engine));
+    //The closed socket frees a descriptor for the reserve, so connections can be taken again.
+    if (!this->_isAcceptPaused) return;
+
+    this->_reserveDescriptor = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if (this->_reserveDescriptor < 0) return;
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = this->_listenSocket;
+    ::epoll_ctl(this->_epoll, EPOLL_CTL_ADD, this->_listenSocket, &event);
+    this->_isAcceptPaused = false;
 }
 
-std::vector<ConnectedCell> Bot::_rankAvailableCells(
-    Player const& player, 
-    std::set<int> const& availableCellNumbers) {
-    const std::shared_ptr<Screen> screen = this->_screen.lock();
-    if (screen == nullptr) throw std::runtime_error("Weak pointer expired.");
+void GameServer::_searchBotTurns() {
+    while (true) {
+        std::shared_ptr<Session> session = nullptr;
 
-    std::vector<ConnectedCell> cells {};
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_botTurnCondition.wait(lock, [this]() { return this->_isStopping || !this->_botTurns.empty(); });
 
-    for (int cell : availableCellNumbers) {
-        const int row = screen->board()->rowByCellNumber(cell);
-        const int column = screen->board()->columnByCellNumber(cell);
-        const ConnectedCell connectedCell = screen->board()->findConnectedCell(row, column, player.marker());
+            if (this->_isStopping) return;
 
-        cells.push_back(connectedCell);
-    }
+            session = this->_botTurns.front();
+            this->_botTurns.pop_front();
+        }
 
-    std::sort(cells.begin(), cells.end(), [](const ConnectedCell& a, const ConnectedCell& b) {
-        const int aChains = a.verticalChain + a.horizontalChain + a.diagonalLeftChain + a.diagonalRightChain;
-        const int bChains = b.verticalChain + b.horizontalChain + b.diagonalLeftChain + b.diagonalRightChain;
+        const Board& board = *session->screen->board();
+        const int cellNumber = board.playerTurn()->requireCellSelection(board);
 
-        return a.totalConnected > b.totalConnected
-            //When total connected cells are equals, rank based on their chains instead.
-            || (a.totalConnected == b.totalConnected && aChains > bChains);
-    });
-    return cells;
+        {
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            this->_botMoves.push_back(BotMove {session, cellNumber});
+        }
+
+        const uint64_t totalMoves = 1;
+        while (::write(this->_botMoveEvent, &totalMoves, sizeof(totalMoves)) < 0 && errno == EINTR) {}
+    }
 }
 
-Player const& Bot::_compareNextTurn(Player const& player1, Player const& player2) {
-    if ((player1.number() < player2.number() && player2.number() < this->_number) //P1 < P2 < Bot.
-        || (player2.number() < this->_number && this->_number < player1.number()) //P2 < Bot < P1.
-        || (this->_number < player1.number() && player1.number() < player2.number()) //Bot < P1 < P2.
-        //It should never happen anyway as every number are unique.
-        //Normally when this bot number equals to second player number, 
-        //the one returned from this method will be second player, but we don't want that.
-        || this->_number == player2.number()) {
-        return player1;
+void GameServer::_applyBotMoves() {
+    uint64_t totalMoves = 0;
+    while (::read(this->_botMoveEvent, &totalMoves, sizeof(totalMoves)) < 0 && errno == EINTR) {}
+
+    std::vector<BotMove> botMoves {};
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        botMoves.swap(this->_botMoves);
     }
 
-    return player2;
-}
+    for (const BotMove& botMove : botMoves) {
+        botMove.session->isBotThinking = false;
+        if (botMove.session->isClosed) continue;
 
-Board::Board(
-    std::shared_ptr<Screen> const screen, 
-    const std::vector<std::shared_ptr<Player>> players,
-    int gridSize) :
-    _screen(screen),
-    _players(players),
-    _gridSize(gridSize),
-    _grid(this->_gridSize, std::vector<std::string>(this->_gridSize)) {
+        this->_markCell(botMove.session, botMove.cellNumber);
+        this->_send(*botMove.session);
+    }
 }
 
-const std::vector<std::shared_ptr<Player>>& Board::players() const { return this->_players; }
+#else
 
-const std::shared_ptr<Player>& Board::playerTurn() const { return this->_playerTurn; }
+void GameServer::run() { throw std::runtime_error("Server mode is only available on Linux."); }
 
-int Board::columnByCellNumber(int cellNumber) { return cellNumber % this->_gridSize; }
+#endif
 
-int Board::rowByCellNumber(int cellNumber) { return cellNumber / this->_gridSize; }
+void GameServer::_handleLine(std::shared_ptr<Session> const& session, std::string_view line) {
+    const std::unique_ptr<Board>& board = session->screen->board();
+    std::string_view command;
+    std::string_view token;
+    int cellNumber = -1;
 
-int Board::cellNumberByPosition(int row, int column) { return row * this->_gridSize + column; }
+    if (!ScriptRunner::nextToken(line, command)) return;
 
-std::set<int> Board::findAvailableCellNumbers() {
-    std::set<int> cells {};
+    if (command == "quit") {
+        session->isQuitting = true;
 
-    for (int row = 0; row < this->_grid.size(); row++) {
-        for (int column = 0; column < this->_grid.at(row).size(); column++) {
-            if (!this->_grid.at(row).at(column).empty()) continue;
+    } else if (command == "board") {
+        if (board == nullptr) {
+            session->output += "error no game has been started\n";
+        } else {
+            this->_appendStateText(*session);
+            this->_appendStatusText(*session);
+        }
 
-            const int cellNumber = this->cellNumberByPosition(row, column);
-            cells.insert(cellNumber);
+    //Anything else changes the board, which has to wait until the bot is done with it.
+    } else if (session->isBotThinking) {
+        session->output += "error waiting for the bot to move\n";
+
+    } else if (command == "new") {
+        this->_startGame(session, line);
+
+    } else if (command == "resume") {
+        this->_resumeGame(session, line);
+
+    } else if (board == nullptr) {
+        session->output += "error no game has been started\n";
+
+    } else if (command == "rematch") {
+        board->reset();
+        board->togglePlayerTurn();
+        session->undoSnapshots.clear();
+        this->_appendStateText(*session);
+        this->_announceTurn(session);
+
+    } else if (command == "undo") {
+        //Finished games are already recorded, so they aren't reopened.
+        if (board->isCompleted()) {
+            session->output += "error the game is over\n";
+        } else if (session->undoSnapshots.empty()) {
+            session->output += "error no human move to undo\n";
+        } else {
+            board->restore(session->undoSnapshots.back());
+            session->undoSnapshots.pop_back();
+            this->_appendStateText(*session);
+            this->_announceTurn(session);
         }
-    }
 
-    return cells;
-}
+    } else if (command == "save") {
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        std::string bytes {};
 
-ConnectedCell Board::findConnectedCell(int row, int column, std::string targetMarker, int maxChain) {
-    //Sum each chain with their opposite direction — top and down, etc. — before totaling them all.
-    //Because we don't want zig-zagging to count as connected cells.
-    //Also imagine a case where user chained a character (x) between left (x1) and right (x2).
-    //    [ x1 ][ x ][ x2 ]
-    //Horizontal chain would be (x) with (x1), and (x) with (x2),
-    //hence we have two chains here and it's valid to be count as three connected cells.
-
-    int total = 0;
-
-    const int verticalChain = this->_countCurrentTopChain(row, column, targetMarker, maxChain)
-        + this->_countCurrentBottomChain(row, column, targetMarker, maxChain);
-    total += verticalChain >= 2 ? verticalChain + 1 : 0; //+1 to include current cell.
-
-    const int horizontalChain = this->_countCurrentLeftChain(row, column, targetMarker, maxChain)
-        + this->_countCurrentRightChain(row, column, targetMarker, maxChain);
-    total += horizontalChain >= 2 ? horizontalChain + 1 : 0; //+1 to include current cell.
-
-    const int diagonalLeftChain = this->_countTopLeftChain(row, column, targetMarker, maxChain)
-        + this->_countBottomRightChain(row, column, targetMarker, maxChain);
-    total += diagonalLeftChain >= 2 ? diagonalLeftChain + 1 : 0; //+1 to include current cell.
-
-    const int diagonalRightChain = this->_countTopRightChain(row, column, targetMarker, maxChain)
-        + this->_countBottomLeftChain(row, column, targetMarker, maxChain);
-    total += diagonalRightChain >= 2 ? diagonalRightChain + 1 : 0; //+1 to include current cell.
-
-    return ConnectedCell {
-        .row = row,
-        .column = column,
-        .verticalChain = verticalChain,
-        .horizontalChain = horizontalChain,
-        .diagonalLeftChain = diagonalLeftChain,
-        .diagonalRightChain = diagonalRightChain,
-        .totalConnected = total
-    };
+        GameRecordFile::appendGame(bytes, *board);
+        session->output += "saved ";
+
+        for (char byte : bytes) {
+            session->output += HEX_DIGITS[static_cast<uint8_t>(byte) >> 4];
+            session->output += HEX_DIGITS[static_cast<uint8_t>(byte) & 0xF];
+        }
+
+        session->output += "\n";
+
+    } else if (command == "move") {
+        const std::shared_ptr<Player>& player = board->playerTurn();
+
+        if (board->isCompleted()) {
+            session->output += "error the game is over\n";
+        } else if (dynamic_cast<const Bot*>(player.get()) != nullptr) {
+            session->output += "error it's a bot turn\n";
+        } else if (!ScriptRunner::nextToken(line, token) 
+            || !ScriptRunner::parseNumber(token, 0, std::numeric_limits<int>::max(), cellNumber)
+            || !board->isCellAvailable(cellNumber)) {
+            session->output += "error invalid cell number\n";
+        } else {
+            session->undoSnapshots.push_back(board->snapshot());
+            this->_markCell(session, cellNumber);
+        }
+
+    } else {
+        session->output += "error unknown command\n";
+    }
 }
 
-std::string Board::scoreText() {
-    std::ostringstream text;
-    text << "Score: \n";
+void GameServer::_startGame(std::shared_ptr<Session> const& session, std::string_view arguments) {
+    std::string_view token;
+    int gridSize = 0;
 
-    for (size_t i = 0; i < this->_players.size(); i++) {
-        Player& player = *this->_players.at(i);   
-        text << player.name() << "-" << i + 1 << " (" << player.marker() << "): " << player.score() << "\n";
+    if (!ScriptRunner::nextToken(arguments, token) || (token != "classic" && token != "frenzy")) {
+        session->output += "error expected 'classic' or 'frenzy'\n";
+        return;
     }
 
-    return text.str();
-}
+    const bool isFrenzy = token == "frenzy";
 
-std::string Board::gridLayoutText() {
-    std::ostringstream text;
-    int cellNumber = 0;
+    if (isFrenzy && (!ScriptRunner::nextToken(arguments, token) 
+        || !ScriptRunner::parseNumber(token, 3, GameServer::MAX_GRID_SIZE, gridSize))) {
+        session->output += "error expected grid size between 3 and " + std::to_string(GameServer::MAX_GRID_SIZE) + "\n";
+        return;
+    }
 
-    for (int y = 0; y < this->_gridSize; y++) {
-        //Note: Amount of strips here are equal to cell 2 width + 2 space around + 1 pipe (|).
-        for (int x = 0; x < this->_gridSize; x++) text << "-----";
-        text << "-\n| ";
-
-        for (int x = 0; x < this->_gridSize; x++) {
-            const std::string currentMarker = this->_grid.at(y).at(x);
-            const std::string marker = currentMarker.empty()
-                //Display its cell number instead of empty string.
-                ? std::to_string(cellNumber % (this->_gridSize * this->_gridSize))
-                : currentMarker;
-
-            //Colorize current cell when they were chained with others.
-            if (!currentMarker.empty() 
-                && this->findConnectedCell(y, x, currentMarker, 3).totalConnected >= 3) {
-                text << TextColor::CYAN;
-            }
+    std::vector<std::shared_ptr<Player>> players {};
+    std::string markers = "";
+
+    while (ScriptRunner::nextToken(arguments, token)) {
+        std::string_view type;
+        const int number = players.size() + 1;
 
-            text << std::setw(2) << marker << TextColor::DEFAULT << " | ";
-            cellNumber++;
+        if (token.size() != 1 || markers.find(token[0]) != std::string::npos) {
+            session->output += "error expected a unique single character marker of player-" 
+                + std::to_string(number) + "\n";
+            return;
         }
 
-        text << "\n";
+        if (!ScriptRunner::nextToken(arguments, type) || (type != "human" && type != "bot")) {
+            session->output += "error expected 'human' or 'bot' for player-" + std::to_string(number) + "\n";
+            return;
+        }
+
+        markers += token[0];
+
+        if (type == "bot") players.push_back(std::make_shared<Bot>(number, std::string(token), this->_searchOptions));
+        else players.push_back(std::make_shared<Player>(number, std::string(token)));
     }
 
-    for (int x = 0; x < this->_gridSize; x++) text << "-----";
-    text << "-\n";
+    //Each cell stores the player number within a single byte, and Classic grid expands to the number of players.
+    const int maxPlayers = isFrenzy ? std::numeric_limits<uint8_t>::max() : GameServer::MAX_GRID_SIZE - 1;
 
-    return text.str();
-}
+    if (players.size() < 2 || static_cast<int>(players.size()) > maxPlayers) {
+        session->output += "error expected between 2 and " + std::to_string(maxPlayers) + " players\n";
+        return;
+    }
 
-std::string Board::playerTurnText() {
-    if (this->_playerTurn == nullptr) throw std::runtime_error("Player turn hasn't been set.");
+    if (isFrenzy) session->screen->setBoard(std::make_unique<FrenzyBoard>(session->screen, players, gridSize));
+    else session->screen->setBoard(ClassicBoard::create(session->screen, players));
 
-    std::ostringstream text;
-    text << this->_playerTurn->name() << "-" << this->_playerTurn->number() 
-        << " (" << this->_playerTurn->marker() << ") turn...\n";
+    if (this->_searchOptions.seed.has_value()) session->screen->board()->seed(*this->_searchOptions.seed);
 
-    return text.str();
+    session->screen->board()->togglePlayerTurn();
+    session->undoSnapshots.clear();
+    this->_appendStateText(*session);
+    this->_announceTurn(session);
 }
 
-std::string Board::resultText() {
-    std::shared_ptr<Player> topPlayer = nullptr;
-    int topScore = 0;
-
-    for (const std::shared_ptr<Player>& player : this->_players) {
-        if (player->score() > topScore) {
-            topPlayer = player;
-            topScore = player->score();
-            
-        //Remove top player if multiple player have equal score.
-        } else if (player->score() == topScore) {
-            topPlayer = nullptr;
+void GameServer::_resumeGame(std::shared_ptr<Session> const& session, std::string_view arguments) {
+    std::string_view token;
+    std::vector<uint8_t> bytes {};
+    const std::function<int(char)> hexValue = [](char digit) {
+        if (digit >= '0' && digit <= '9') return digit - '0';
+        if (digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+        return -1;
+    };
+
+    if (!ScriptRunner::nextToken(arguments, token) || token.size() % 2 != 0) {
+        session->output += "error expected hex of a saved game\n";
+        return;
+    }
+
+    for (size_t i = 0; i < token.size(); i += 2) {
+        const int high = hexValue(token[i]);
+        const int low = hexValue(token[i + 1]);
+
+        if (high < 0 || low < 0) {
+            session->output += "error expected hex of a saved game\n";
+            return;
         }
+
+        bytes.push_back(static_cast<uint8_t>(high << 4 | low));
     }
 
-    std::ostringstream winText;
-    const std::string drawText = "Game over! The game ends with draw.\n";
+    std::unique_ptr<Board> board = nullptr;
 
-    if (topPlayer == nullptr) return drawText;
+    try {
+        const GameRecord record = GameRecordFile::readGame(bytes.data(), bytes.size(), 0);
 
-    winText << "Game over! " << topPlayer->name() << "-" << topPlayer->number()
-        << " (" << topPlayer->marker() << ") has won!\n";  	
-    return winText.str();
-}
+        //Held to the same limits as a game started by the client.
+        if (record.gridSize > GameServer::MAX_GRID_SIZE) throw std::runtime_error("Grid is too big.");
+
+        for (const std::string& marker : record.markers) {
+            if (marker.size() != 1) throw std::runtime_error("Markers have to be a single character.");
+        }
 
-bool Board::markCellByNumber(int cellNumber, std::string marker) {
-    const int x = this->columnByCellNumber(cellNumber);
-    const int y = this->rowByCellNumber(cellNumber);
-
-    if (x < 0 
-        || x >= this->_gridSize 
-        || y < 0 
-        || y >= this->_gridSize
-        || !this->_grid.at(y).at(x).empty()
-        || this->_playerTurn == nullptr) {
-        return false;
+        board = record.createBoard(session->screen, std::numeric_limits<size_t>::max(), this->_searchOptions);
+    } catch (std::exception const& exception) {
+        session->output += "error invalid saved game\n";
+        return;
     }
 
-    this->_grid.at(y).at(x) = marker;
-    const int totalConnected = this->findConnectedCell(y, x, marker).totalConnected;
-    const int score = this->_playerTurn->score() + totalConnected;
+    if (this->_searchOptions.seed.has_value()) board->seed(*this->_searchOptions.seed);
 
-    this->_playerTurn->setScore(score);
-    return true;
+    session->screen->setBoard(std::move(board));
+    session->undoSnapshots.clear();
+    this->_appendStateText(*session);
+    this->_announceTurn(session);
 }
 
-void Board::reset() {
-    this->_grid = std::vector<std::vector<std::string>>(
-        this->_gridSize,   
-        std::vector<std::string>(this->_gridSize)
-    );
-    this->_playerTurn = nullptr;
+void GameServer::_markCell(std::shared_ptr<Session> const& session, int cellNumber) {
+    Board& board = *session->screen->board();
+    const int playerNumber = board.playerTurn()->number();
+    const int previousScore = board.score(playerNumber);
 
-    for (std::shared_ptr<Player> player : this->_players) player->reset();
-}
+    board.markCellByNumber(cellNumber, playerNumber);
+    board.togglePlayerTurn();
+
+    session->output += "moved " + std::to_string(playerNumber) + " " + std::to_string(cellNumber) + " " 
+        + std::to_string(board.score(playerNumber) - previousScore) + "\nscore";
+
+    for (const std::shared_ptr<Player>& player : board.players()) {
+        session->output += " " + std::to_string(board.score(player->number()));
+    }
 
-void Board::togglePlayerTurn() {
-    std::default_random_engine engine(std::random_device{}());
-    std::uniform_int_distribution<int> randomIndex(
-        0, 
-        std::max(0, static_cast<int>(this->_players.size()) - 1)
-    );
-    int playerTurnIndex = this->_playerTurn == nullptr ? -1 : this->_playerTurn->number() - 1;
-
-    //Only randomly pick the turn during initial run. 
-    //From then on, it's incremented from previous player index.
-    if (playerTurnIndex == -1) playerTurnIndex = randomIndex(engine);
-    else if (playerTurnIndex + 1 >= this->_players.size()) playerTurnIndex = 0;
-    else playerTurnIndex++;
-
-    this->_playerTurn = this->_players.at(playerTurnIndex);
+    session->output += "\n";
+
+    //Only the move finishing the game records it, not a resumed game that's already over.
+    if (board.isCompleted() && this->_recordWriter != nullptr) {
+        this->_recordWriter->write(board);
+        this->_recordWriter->flush();
+    }
+
+    this->_announceTurn(session);
 }
 
-int Board::requireGridSelection() {
-    std::shared_ptr<Screen> screen = this->_screen.lock();
-    if (!screen) throw std::runtime_error("Weak pointer expired.");
+void GameServer::_announceTurn(std::shared_ptr<Session> const& session) {
+    const Board& board = *session->screen->board();
 
-    const int maxCell = std::max(0, (this->_gridSize * this->_gridSize) - 1);
-    const int maxRowOrColumn = std::max(0, this->_gridSize - 1);
-    int selectedCell = -1;
+    this->_appendStatusText(*session);
 
-    screen->clear();
-    std::cout << screen->retainedText()[Screen::RetainedTextKey::GAME_MODE_HEADER] << "\n"
-        << screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY]
-        << this->scoreText() << "\n" 
-        << this->gridLayoutText() << "\n"
-        << this->playerTurnText();
+    if (board.isCompleted()) return;
 
-    while (true) {
-        std::string line;
-        std::cout << "Select cell by number: ";
-        std::getline(std::cin, line);
-        std::cout << "\n";
-
-        std::stringstream lineStream(line);
-
-        if (lineStream >> selectedCell && lineStream.eof()) {
-            const int x = this->columnByCellNumber(selectedCell);
-            const int y = this->rowByCellNumber(selectedCell);
-
-            if (selectedCell >= 0
-                && selectedCell <= maxCell
-                && x >= 0 
-                && x <= maxRowOrColumn
-                && y >= 0 
-                && y <= maxRowOrColumn
-                && this->_grid.at(y).at(x).empty()) {
-                break;
-            }
-        }
+    if (dynamic_cast<const Bot*>(board.playerTurn().get()) == nullptr) return;
 
-        selectedCell = -1;
-        screen->clear();
+    session->isBotThinking = true;
 
-        std::cout << screen->retainedText()[Screen::RetainedTextKey::GAME_MODE_HEADER] << "\n"
-            << screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY]
-            << this->scoreText() << "\n" 
-            << this->gridLayoutText() << "\n"
-            << this->playerTurnText() << "\n"
-            << "** Invalid cell number, please reselect!\n";
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_botTurns.push_back(session);
     }
 
-    return selectedCell;
+    this->_botTurnCondition.notify_one();
 }
 
-bool Board::requireRematch() {
-    std::string line;
+void GameServer::_appendStateText(Session& session) const {
+    const Board& board = *session.screen->board();
+    const int totalCells = board.gridSize() * board.gridSize();
 
-    std::cout << "Rematch? (y/n) ";
-    std::getline(std::cin, line);
-    std::cout << "\n";
+    session.output += "players";
 
-    for (char& ch : line) ch = std::tolower(ch);
+    for (const std::shared_ptr<Player>& player : board.players()) {
+        session.output += " " + player->marker() + ":" 
+            + (dynamic_cast<const Bot*>(player.get()) != nullptr ? "bot" : "human");
+    }
 
-    return line == "y" || line == "yes";
-}
+    session.output += "\ngrid " + std::to_string(board.gridSize());
 
-int Board::_countChainByDirection(
-    int row, 
-    int column, 
-    int deltaRow, 
-    int deltaColumn, 
-    std::string targetMarker,
-    int maxChain) {
-    int chain = 0;       
-
-    do {
-        row += deltaRow;
-        column += deltaColumn;
-
-        //The loop traverse in the specified direction until a different character 
-        //is encountered or the grid boundaries are reached.
-        if (row < 0 
-            || row >= this->_gridSize
-            || column < 0 
-            || column >= this->_gridSize
-            || this->_grid.at(row).at(column) != targetMarker) {
-            break;
-        }        
+    for (int cell = 0; cell < totalCells; cell++) session.output += " " + std::to_string(board.cellPlayerNumber(cell));
 
-        chain++;
+    session.output += "\nscore";
 
-    } while (chain < maxChain);
+    for (const std::shared_ptr<Player>& player : board.players()) {
+        session.output += " " + std::to_string(board.score(player->number()));
+    }
 
-    return chain;
+    session.output += "\n";
 }
 
-int Board::_countCurrentTopChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, -1, 0, targetMarker, maxChain);
-}
+void GameServer::_appendStatusText(Session& session) const {
+    const Board& board = *session.screen->board();
 
-int Board::_countCurrentBottomChain(int row, int column, std::string targetMarker, int maxChain)  {
-    return this->_countChainByDirection(row, column, 1, 0, targetMarker, maxChain);
-}
+    if (!board.isCompleted()) {
+        session.output += "turn " + std::to_string(board.playerTurn()->number()) + "\n";
+        return;
+    }
 
-int Board::_countCurrentLeftChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, 0, -1, targetMarker, maxChain);
+    const std::shared_ptr<Player> winner = board.winner();
+    session.output += winner == nullptr ? "over draw\n" : "over won " + std::to_string(winner->number()) + "\n";
 }
 
-int Board::_countCurrentRightChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, 0, 1, targetMarker, maxChain);
+const std::string CommandLine::usageText() {
+    return 
+        "Usage: tic-tac-toe [--record <file>]\n"
+        "       tic-tac-toe --simulate <games> [options] [--record <file>]\n"
+        "       tic-tac-toe --replay <file> [--game <index>] [--moves <amount>]\n"
+        "       tic-tac-toe --script <file> [--record <file>]\n"
+        "       tic-tac-toe --serve <port> [bot options] [--record <file>]\n"
+        "       tic-tac-toe --benchmark [--filter <text>] [--min-time <ms>]\n"
+        "       tic-tac-toe --build-book <file> --from <file> [--moves <amount>]\n"
+        "Without any argument, the game is played interactively.\n"
+        "\n"
+        "  --record <file>       Append every finished game into given game record.\n"
+        "  --metrics <file>      Export latency and work of bot moves as JSON once games are over,\n"
+        "                        or once the benchmark is done or the server is stopped.\n"
+        "                        Only available when built with -DINSTRUMENTATION.\n"
+        "\n"
+        "Simulation options:\n"
+        "  --simulate <games>    Play given amount of bot-only games without rendering them.\n"
+        "  --mode <mode>         Either 'classic' or 'frenzy'. Defaults to classic.\n"
+        "  --grid <size>         Grid size of Frenzy mode, min 3. Defaults to 3.\n"
+        "  --bots <amount>       Number of bots, min 2. Defaults to 2.\n"
+        "  --batch <games>       Play given amount of games at once on each thread, where bots\n"
+        "                        mark the candidate valued best by one batched evaluation.\n"
+        "                        Bots don't search, taking neither '--depth' nor '--mcts'.\n"
+        "\n"
+        "Bot options, for both simulations and servers:\n"
+        "  --jobs <amount>       Games played or bot moves searched at the same time.\n"
+        "                        Defaults to every core.\n"
+        "  --depth <moves>       Maximum moves each bot looks ahead, one to disable it.\n"
+        "  --candidates <cells>  Amount of ranked cells each bot considers on each move.\n"
+        "  --time-budget <ms>    Time each bot may spend looking ahead on each move.\n"
+        "  --threads <amount>    Threads each bot searches with.\n"
+        "  --lazy-smp            Share the search through the table instead of splitting cells.\n"
+        "  --table-mb <size>     Megabytes of the transposition table of each bot. Defaults to 8,\n"
+        "                        or 1 for servers.\n"
+        "  --mcts <playouts>     Search with Monte Carlo tree search instead of alpha-beta, which\n"
+        "                        suits big Frenzy grids with many players. Only reproducible\n"
+        "                        with a single thread when seeded.\n"
+        "  --mcts-mb <size>      Megabytes of each of the two node pools of Monte Carlo tree search.\n"
+        "                        Defaults to 8, or 1 for servers.\n"
+        "  --seed <number>       Make games reproducible, seeding their random picks and only\n"
+        "                        limiting the search with the depth.\n"
+        "  --book <file>         Opening book for bots to play known positions straight away.\n"
+        "  --no-solved-book      Let bots search on Classic 3x3 grid instead of playing perfectly.\n"
+        "  --evaluator <names>   Either 'chain' or 'pattern'. Defaults to chain. Simulations take\n"
+        "                        a list such as 'chain,pattern', given to the bots in turns.\n"
+        "\n"
+        "Replay options:\n"
+        "  --replay <file>       Print a game from given game record.\n"
+        "  --game <index>        Index of the game within the record, from zero. Defaults to 0.\n"
+        "  --moves <amount>      Only replay given amount of moves. Defaults to every move.\n"
+        "\n"
+        "Server options:\n"
+        "  --serve <port>        Host games for clients over TCP, which send lines such as\n"
+        "                        'new classic X human O bot', 'move 4', 'undo', 'save' or 'quit'.\n"
+        "\n"
+        "Script options:\n"
+        "  --script <file>       Play games from given script without prompting, '-' reads the input.\n"
+        "                        Each line is a game of mode, grid size for Frenzy mode, total players,\n"
+        "                        their markers and then each move, e.g. 'classic 2 X O 4 0 8'.\n"
+        "\n"
+        "Benchmark options:\n"
+        "  --benchmark           Time board and bot hot paths on seeded boards of many sizes.\n"
+        "  --filter <text>       Only time cases whose name contains it, e.g. 'grid:32/'.\n"
+        "  --min-time <ms>       Least time spent repeating each case. Defaults to 100.\n"
+        "\n"
+        "Opening book options:\n"
+        "  --build-book <file>   Save an opening book of the cells winners marked the most,\n"
+        "                        to be played by bots with '--book'.\n"
+        "  --from <file>         Game record the book is built from, e.g. of seeded simulations.\n"
+        "  --moves <amount>      Only take given amount of moves from each game. Defaults to every move.\n";
 }
 
-int Board::_countTopLeftChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, -1, -1, targetMarker, maxChain);
-}
+void CommandLine::parse(std::vector<std::string> const& arguments, CommandLineOptions& options) {
+    SimulationOptions& simulationOptions = options.simulationOptions;
 
-int Board::_countTopRightChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, -1, 1, targetMarker, maxChain);
-}
+    const std::function<std::string const&(size_t&)> requireValue = [&arguments](size_t& i) -> std::string const& {
+        if (i + 1 >= arguments.size()) throw std::runtime_error("Missing value of '" + arguments.at(i) + "'.");
+        return arguments.at(++i);
+    };
+    const std::function<long(size_t&, long)> requireNumber = [&arguments](size_t& i, long minValue) {
+        const std::string& name = arguments.at(i);
+        if (i + 1 >= arguments.size()) throw std::runtime_error("Missing value of '" + name + "'.");
 
-int Board::_countBottomLeftChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, 1, -1, targetMarker, maxChain);
-}
+        long value = 0;
+        std::stringstream valueStream(arguments.at(++i));
 
-int Board::_countBottomRightChain(int row, int column, std::string targetMarker, int maxChain) {
-    return this->_countChainByDirection(row, column, 1, 1, targetMarker, maxChain);
-}
+        if (!(valueStream >> value) || !valueStream.eof() || value < minValue) {
+            throw std::runtime_error(
+                "Invalid value of '" + name + "', expected a number of at least " 
+                + std::to_string(minValue) + ".");
+        }
 
-ClassicBoard::ClassicBoard(
-    std::shared_ptr<Screen> const screen, 
-    const std::vector<std::shared_ptr<Player>> players) : 
-    Board(screen, players, players.size() + 1) {
-}
+        return value;
+    };
+    //First option given that only belongs to each mode, to tell it apart from a misplaced one.
+    std::string simulationArgument = "";
+    //Options of the bots, which are shared by simulations and servers.
+    std::string botArgument = "";
+    //Options of the search, which batched bots don't do.
+    std::string searchArgument = "";
+    std::string replayArgument = "";
+    std::string benchmarkArgument = "";
+    std::string bookArgument = "";
+    //Moves are shared by replays and opening books.
+    bool isMovesGiven = false;
+    std::string recordPath = "";
+
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const std::string& argument = arguments.at(i);
+
+        if (argument == "--record") {
+            recordPath = requireValue(i);
+
+        } else if (argument == "--metrics") {
+            options.metricsPath = requireValue(i);
+#if !defined(INSTRUMENTATION)
+            throw std::runtime_error("Metrics are only recorded when built with '-DINSTRUMENTATION'.");
+#endif
+
+        } else if (argument == "--replay") {
+            options.mode = CommandLineOptions::Mode::REPLAY;
+            options.replayPath = requireValue(i);
+
+        } else if (argument == "--script") {
+            options.mode = CommandLineOptions::Mode::SCRIPT;
+            options.scriptPath = requireValue(i);
+
+        } else if (argument == "--serve") {
+            options.mode = CommandLineOptions::Mode::SERVE;
+            options.serverPort = requireNumber(i, 1);
+
+            if (options.serverPort > std::numeric_limits<uint16_t>::max()) {
+                throw std::runtime_error(
+                    "Invalid value of '--serve', expected at most " 
+                    + std::to_string(std::numeric_limits<uint16_t>::max()) + ".");
+            }
 
-const std::string ClassicBoard::nameAndDescription() {
-    const std::string title =  "Classic";
-    std::string text = title + "\n";
+        } else if (argument == "--benchmark") {
+            options.mode = CommandLineOptions::Mode::BENCHMARK;
 
-    for (size_t i = 0; i < title.length(); i++) text += "-";
+        } else if (argument == "--build-book") {
+            options.mode = CommandLineOptions::Mode::BUILD_BOOK;
+            options.bookPath = requireValue(i);
 
-    text += "\nConnect three characters to win the game.\n";
-    return text;
-}
+        } else if (argument == "--from") {
+            options.bookRecordPath = requireValue(i);
+            if (bookArgument.empty()) bookArgument = argument;
+
+        } else if (argument == "--filter") {
+            options.benchmarkOptions.filter = requireValue(i);
+            if (benchmarkArgument.empty()) benchmarkArgument = argument;
+
+        } else if (argument == "--min-time") {
+            options.benchmarkOptions.minTime = std::chrono::milliseconds(requireNumber(i, 1));
+            if (benchmarkArgument.empty()) benchmarkArgument = argument;
+
+        } else if (argument == "--game") {
+            options.replayGameIndex = requireNumber(i, 0);
+            if (replayArgument.empty()) replayArgument = argument;
+
+        } else if (argument == "--moves") {
+            options.totalReplayMoves = requireNumber(i, 0);
+            isMovesGiven = true;
 
-bool ClassicBoard::isCompleted() {
-    if (this->findAvailableCellNumbers().empty()) return true;
+        } else {
+            if (argument == "--simulate") {
+                options.mode = CommandLineOptions::Mode::SIMULATE;
+                simulationOptions.totalGames = requireNumber(i, 1);
 
-    //Finish the game as soon someone scored.
-    for (const std::shared_ptr<Player>& player : this->_players) {
-        if (player->score() > 0) return true;
+            } else if (argument == "--mode") {
+                const std::string mode = requireValue(i);
+                if (mode != "classic" && mode != "frenzy") {
+                    throw std::runtime_error("Invalid value of '--mode', expected 'classic' or 'frenzy'.");
+                }
+
+                simulationOptions.isFrenzy = mode == "frenzy";
+
+            } else if (argument == "--grid") {
+                simulationOptions.gridSize = requireNumber(i, 3);
+
+            } else if (argument == "--bots") {
+                simulationOptions.totalBots = requireNumber(i, 2);
+
+                //Each cell stores the player number within a single byte.
+                if (simulationOptions.totalBots > std::numeric_limits<uint8_t>::max()) {
+                    throw std::runtime_error(
+                        "Invalid value of '--bots', expected at most " 
+                        + std::to_string(std::numeric_limits<uint8_t>::max()) + ".");
+                }
+
+            } else if (argument == "--batch") {
+                simulationOptions.batchSize = requireNumber(i, 1);
+                simulationOptions.batchEvaluator = std::make_shared<const LineBatchEvaluator>();
+
+            } else if (argument == "--jobs") {
+                simulationOptions.totalJobs = requireNumber(i, 1);
+            } else if (argument == "--depth") {
+                simulationOptions.searchOptions.maxDepth = requireNumber(i, 1);
+            } else if (argument == "--candidates") {
+                simulationOptions.searchOptions.candidateLimit = requireNumber(i, 0);
+            } else if (argument == "--time-budget") {
+                simulationOptions.searchOptions.timeBudget = std::chrono::milliseconds(requireNumber(i, 0));
+            } else if (argument == "--threads") {
+                simulationOptions.searchOptions.totalThreads = requireNumber(i, 1);
+            } else if (argument == "--lazy-smp") {
+                simulationOptions.searchOptions.isLazySmp = true;
+            } else if (argument == "--table-mb") {
+                simulationOptions.searchOptions.transpositionTableMegabytes = requireNumber(i, 1);
+            } else if (argument == "--mcts") {
+                simulationOptions.searchOptions.monteCarloPlayouts = requireNumber(i, 1);
+            } else if (argument == "--mcts-mb") {
+                simulationOptions.searchOptions.monteCarloTreeMegabytes = requireNumber(i, 1);
+            } else if (argument == "--seed") {
+                simulationOptions.searchOptions.seed = requireNumber(i, 0);
+            } else if (argument == "--book") {
+                simulationOptions.searchOptions.openingBook = 
+                    std::make_shared<const OpeningBook>(OpeningBook::load(requireValue(i)));
+            } else if (argument == "--no-solved-book") {
+                simulationOptions.searchOptions.isSolvedBookUsed = false;
+            } else if (argument == "--evaluator") {
+                std::istringstream names(requireValue(i));
+                std::string name;
+                simulationOptions.evaluators.clear();
+
+                while (std::getline(names, name, ',')) simulationOptions.evaluators.push_back(Evaluator::create(name));
+
+                if (simulationOptions.evaluators.empty()) {
+                    throw std::runtime_error("Invalid value of '--evaluator', expected at least one evaluator.");
+                }
+
+                simulationOptions.searchOptions.evaluator = simulationOptions.evaluators.at(0);
+            } else {
+                throw std::runtime_error("Unknown argument '" + argument + "'.");
+            }
+
+            const bool isSearchArgument = argument == "--depth" 
+                || argument == "--time-budget" 
+                || argument == "--threads" 
+                || argument == "--lazy-smp" 
+                || argument == "--table-mb" 
+                || argument == "--mcts" 
+                || argument == "--mcts-mb" 
+                || argument == "--book";
+
+            if (isSearchArgument && searchArgument.empty()) searchArgument = argument;
+
+            const bool isSimulationArgument = argument == "--mode" 
+                || argument == "--grid" 
+                || argument == "--bots" 
+                || argument == "--batch";
+
+            if (isSimulationArgument && simulationArgument.empty()) simulationArgument = argument;
+            else if (!isSimulationArgument && argument != "--simulate" && botArgument.empty()) botArgument = argument;
+        }
     }
 
-    return false;
+    const size_t totalModes = std::count_if(arguments.begin(), arguments.end(), [](std::string const& argument) {
+        return argument == "--simulate" 
+            || argument == "--replay" 
+            || argument == "--script" 
+            || argument == "--serve" 
+            || argument == "--benchmark"
+            || argument == "--build-book";
+    });
+
+    if (totalModes > 1) {
+        throw std::runtime_error(
+            "Only one of '--simulate', '--replay', '--script', '--serve', '--benchmark' or '--build-book' "
+            "can be given.");
+    }
+
+    if (options.mode == CommandLineOptions::Mode::BENCHMARK && !recordPath.empty()) {
+        throw std::runtime_error("Benchmarked games can't be recorded.");
+    }
+
+    if (options.mode == CommandLineOptions::Mode::REPLAY && !recordPath.empty()) {
+        throw std::runtime_error("Replayed games can't be recorded again.");
+    }
+
+    if (options.mode == CommandLineOptions::Mode::BUILD_BOOK && !recordPath.empty()) {
+        throw std::runtime_error("Games of an opening book can't be recorded again.");
+    }
+
+    if (options.mode == CommandLineOptions::Mode::BUILD_BOOK && options.bookRecordPath.empty()) {
+        throw std::runtime_error("Missing '--from', opening books are built from a game record.");
+    }
+
+    if (!simulationArgument.empty() && options.mode != CommandLineOptions::Mode::SIMULATE) {
+        throw std::runtime_error("Missing '--simulate', '" + simulationArgument + "' is only used by simulations.");
+    }
+
+    if (!botArgument.empty() 
+        && options.mode != CommandLineOptions::Mode::SIMULATE 
+        && options.mode != CommandLineOptions::Mode::SERVE) {
+        throw std::runtime_error(
+            "Missing '--simulate' or '--serve', '" + botArgument + "' is only used by simulations and servers.");
+    }
+
+    if (simulationOptions.batchEvaluator != nullptr && !searchArgument.empty()) {
+        throw std::runtime_error("Batched bots mark candidates without searching, '" + searchArgument 
+            + "' can't be given with '--batch'.");
+    }
+
+    if (options.mode == CommandLineOptions::Mode::SERVE && simulationOptions.evaluators.size() > 1) {
+        throw std::runtime_error("Only simulations can give bots different evaluators.");
+    }
+
+    const std::function<bool(std::string const&)> isGiven = [&arguments](std::string const& name) {
+        return std::find(arguments.begin(), arguments.end(), name) != arguments.end();
+    };
+
+    if (options.mode == CommandLineOptions::Mode::SERVE && !isGiven("--table-mb")) {
+        simulationOptions.searchOptions.transpositionTableMegabytes = GameServer::SESSION_TABLE_MEGABYTES;
+    }
+
+    if (options.mode == CommandLineOptions::Mode::SERVE && !isGiven("--mcts-mb")) {
+        simulationOptions.searchOptions.monteCarloTreeMegabytes = GameServer::SESSION_TABLE_MEGABYTES;
+    }
+
+    if (!replayArgument.empty() && options.mode != CommandLineOptions::Mode::REPLAY) {
+        throw std::runtime_error("Missing '--replay', '" + replayArgument + "' is only used by replays.");
+    }
+
+    if (isMovesGiven 
+        && options.mode != CommandLineOptions::Mode::REPLAY 
+        && options.mode != CommandLineOptions::Mode::BUILD_BOOK) {
+        throw std::runtime_error(
+            "Missing '--replay' or '--build-book', '--moves' is only used by replays and opening books.");
+    }
+
+    if (!bookArgument.empty() && options.mode != CommandLineOptions::Mode::BUILD_BOOK) {
+        throw std::runtime_error("Missing '--build-book', '" + bookArgument + "' is only used by opening books.");
+    }
+
+    if (!benchmarkArgument.empty() && options.mode != CommandLineOptions::Mode::BENCHMARK) {
+        throw std::runtime_error("Missing '--benchmark', '" + benchmarkArgument + "' is only used by benchmarks.");
+    }
+
+    //Only opened once every argument is valid, so a typo doesn't leave an empty record behind.
+    if (!recordPath.empty()) options.recordWriter = std::make_shared<GameRecordWriter>(recordPath);
 }
 
-FrenzyBoard::FrenzyBoard(
-    std::shared_ptr<Screen> const screen, 
-    const std::vector<std::shared_ptr<Player>> players, 
-    int gridSize) : 
-    Board(screen, players, gridSize) {
+std::string CommandLine::buildBook(CommandLineOptions const& options) {
+    size_t totalGames = 0;
+    const OpeningBook book = OpeningBook::build(
+        GameRecordReader(options.bookRecordPath), options.totalReplayMoves, totalGames);
+    std::ostringstream text;
+
+    book.save(options.bookPath);
+    text << "Built opening book '" << options.bookPath << "' of " << book.size() << " positions from " 
+        << totalGames << " games.\n";
+    return text.str();
 }
 
-const std::string FrenzyBoard::nameAndDescription() {
-    const std::string title =  "Frenzy";
-    std::string text = title + "\n";
+std::string CommandLine::replayText(CommandLineOptions const& options) {
+    const GameRecord record = GameRecordReader(options.replayPath).read(options.replayGameIndex);
+    const std::shared_ptr<Screen> screen = std::make_shared<Screen>();
+    const std::unique_ptr<Board> board = record.createBoard(screen, options.totalReplayMoves);
+    std::ostringstream text;
 
-    for (size_t i = 0; i < title.length(); i++) text += "-";
+    text << (record.isFrenzy ? FrenzyBoard::nameAndDescription() : ClassicBoard::nameAndDescription()) << "\n"
+        << board->moveHistoryText()
+        << board->scoreText() << "\n"
+        << board->gridLayoutText() << "\n"
+        << (board->isCompleted() ? board->resultText() : board->playerTurnText());
 
-    text += "\nConnect three or more characters to earn points.\n"
-        "The one with the most points wins.\n";
-    return text;
+    return text.str();
 }
 
-bool FrenzyBoard::isCompleted() { return this->findAvailableCellNumbers().empty(); }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace tic_tac_toe;
+
+    const std::vector<std::string> arguments(argv + 1, argv + argc);
+    CommandLineOptions options;
+
+    try {
+        CommandLine::parse(arguments, options);
+
+        if (options.mode == CommandLineOptions::Mode::SIMULATE) {
+            Simulation simulation(options.simulationOptions, options.recordWriter);
+            simulation.run();
+
+            std::cout << simulation.summaryText();
+            INSTRUMENT(Instrumentation::dump(options.metricsPath);)
+            return 0;
+
+        } else if (options.mode == CommandLineOptions::Mode::REPLAY) {
+            std::cout << CommandLine::replayText(options);
+            return 0;
+
+        } else if (options.mode == CommandLineOptions::Mode::BUILD_BOOK) {
+            std::cout << CommandLine::buildBook(options);
+            return 0;
+
+        } else if (options.mode == CommandLineOptions::Mode::SERVE) {
+            GameServer server(
+                options.serverPort, 
+                options.simulationOptions.totalJobs, 
+                options.simulationOptions.searchOptions, 
+                options.recordWriter);
+            server.run();
+            INSTRUMENT(Instrumentation::dump(options.metricsPath);)
+            return 0;
+
+        } else if (options.mode == CommandLineOptions::Mode::BENCHMARK) {
+            Benchmark benchmark(options.benchmarkOptions);
+            benchmark.run();
+
+            std::cout << benchmark.resultText();
+            INSTRUMENT(Instrumentation::dump(options.metricsPath);)
+            return 0;
+
+        } else if (options.mode == CommandLineOptions::Mode::SCRIPT) {
+            const std::string script = ScriptRunner::readScript(options.scriptPath);
+            std::string results {};
+
+            ScriptRunner(options.recordWriter).run(script, results);
+            std::cout << results;
+            INSTRUMENT(Instrumentation::dump(options.metricsPath);)
+            return 0;
+        }
+
+    } catch (std::runtime_error const& error) {
+        std::cerr << error.what() << "\n\n" << CommandLine::usageText();
+        return 1;
+    }
 
-int main() {
     std::shared_ptr<Screen>screen = std::make_shared<Screen>();
     screen->setBoard(screen->requireGameMode());
 
     while (true) {
         if (screen->board()->isCompleted()) {
             std::cout << screen->board()->resultText() << "\n";
+            INSTRUMENT(Instrumentation::dump(options.metricsPath);)
+
+            if (options.recordWriter != nullptr) {
+                options.recordWriter->write(*screen->board());
+                options.recordWriter->flush();
+            }
 
             screen->board()->reset();
             screen->board()->togglePlayerTurn();
-            screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY] = "";
 
             //User don't want to rematch.
             if (!screen->board()->requireRematch()) {
@@ -1039,26 +1767,14 @@ int main() {
         }
 
         const std::shared_ptr<Player> currentPlayerTurn = screen->board()->playerTurn();
-        const int selectedCell = currentPlayerTurn->requireCellSelection();
+        const int selectedCell = currentPlayerTurn->requireCellSelection(*screen->board());
+        INSTRUMENT(const Instrumentation::TurnScope turnScope {};)
 
-        screen->board()->markCellByNumber(selectedCell, currentPlayerTurn->marker());
+        screen->board()->markCellByNumber(selectedCell, currentPlayerTurn->number());
         screen->board()->togglePlayerTurn();
-        screen->clear();
-
-        const int scoreGained = currentPlayerTurn->score() - currentPlayerTurn->lastScore();
-        std::ostringstream selectedCellText;
-
-        selectedCellText << screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY]
-            << currentPlayerTurn->name() << "-" << currentPlayerTurn->number()
-            << " (" << currentPlayerTurn->marker() << ") selected '" << selectedCell << "'";
-
-        if (scoreGained > 0) selectedCellText << ", gained +" << scoreGained << " points";
-
-        screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY] = selectedCellText.str() + "\n\n";
-        std::cout << screen->retainedText()[Screen::RetainedTextKey::GAME_MODE_HEADER] << "\n"
-            << screen->retainedText()[Screen::RetainedTextKey::SELECTED_CELL_HISTORY]
-            << screen->board()->scoreText() << "\n" 
-            << screen->board()->gridLayoutText() << "\n";
+        screen->beginFrame();
+        screen->appendGameFrame(*screen->board());
+        screen->writeFrame();
     }
 
     return 0;
@@ -0,0 +1,381 @@
+// Copyright (c) 2023 robifr
+// This code is licensed under the MIT License.
+// For details, visit: https://opensource.org/licenses/MIT
+
+#define TIC_TAC_TOE_IMPLEMENTATION
+#include "tic-tac-toe.hpp"
+
+#include <filesystem>
+
+namespace tic_tac_toe {
+
+/**
+ * Plays seeded random games, checking after every move and undo that the state boards keep up to date
+ * matches the same state computed again from scratch. Built and run with `make test`.
+ */
+class BoardTest {
+public:
+    BoardTest(uint64_t seed);
+
+    /**
+     * Run every test, returning the amount of failed checks.
+     */
+    long run();
+
+private:
+    //Failures printed before only counting the rest, as one broken state usually fails many checks.
+    static constexpr long MAX_PRINTED_FAILURES = 10;
+
+    RandomEngine _random;
+    const std::shared_ptr<Screen> _screen = std::make_shared<Screen>();
+    long _totalChecks = 0;
+    long _totalFailures = 0;
+
+    void _check(bool isPassed, std::string const& name);
+
+    std::vector<std::shared_ptr<Player>> _createPlayers(int totalPlayers);
+
+    /**
+     * Frenzy board of random grid size or the generic Classic board, without the fixed ones.
+     */
+    std::unique_ptr<Board> _createBoard(bool isFrenzy, std::vector<std::shared_ptr<Player>> const& players);
+
+    int _randomAvailableCell(Board const& board);
+
+    /**
+     * Same kind of board with only the moves of given board marked onto it, one after another.
+     */
+    std::unique_ptr<Board> _replay(Board const& board);
+
+    /**
+     * Compare what given board keeps up to date on each move against the same state found from scratch.
+     */
+    void _checkIncrementalState(Board const& board, std::string const& name);
+
+    void _checkSameMoves(Board const& board, Board const& otherBoard, std::string const& name);
+
+    void _testMovesAndUndos();
+
+    void _testSnapshots();
+
+    void _testFixedClassicBoards();
+
+    void _testGameRecords();
+};
+
+BoardTest::BoardTest(uint64_t seed) : _random(seed) {}
+
+long BoardTest::run() {
+    this->_testMovesAndUndos();
+    this->_testSnapshots();
+    this->_testFixedClassicBoards();
+    this->_testGameRecords();
+
+    std::cout << "Checks: " << this->_totalChecks << ", failures: " << this->_totalFailures << "\n";
+    return this->_totalFailures;
+}
+
+void BoardTest::_check(bool isPassed, std::string const& name) {
+    this->_totalChecks++;
+    if (isPassed) return;
+
+    if (this->_totalFailures < BoardTest::MAX_PRINTED_FAILURES) std::cout << "Failed: " << name << "\n";
+
+    this->_totalFailures++;
+}
+
+std::vector<std::shared_ptr<Player>> BoardTest::_createPlayers(int totalPlayers) {
+    std::vector<std::shared_ptr<Player>> players {};
+
+    for (int number = 1; number <= totalPlayers; number++) {
+        players.push_back(std::make_shared<Player>(number, std::string(1, 'A' + number - 1)));
+    }
+
+    return players;
+}
+
+std::unique_ptr<Board> BoardTest::_createBoard(bool isFrenzy, std::vector<std::shared_ptr<Player>> const& players) {
+    if (!isFrenzy) return std::make_unique<ClassicBoard>(this->_screen, players);
+
+    return std::make_unique<FrenzyBoard>(this->_screen, players, 3 + this->_random.below(10));
+}
+
+int BoardTest::_randomAvailableCell(Board const& board) {
+    return board.availableCellNumber(this->_random.below(board.totalAvailableCells()));
+}
+
+std::unique_ptr<Board> BoardTest::_replay(Board const& board) {
+    std::unique_ptr<Board> replayedBoard = dynamic_cast<const FrenzyBoard*>(&board) != nullptr
+        ? std::unique_ptr<Board>(std::make_unique<FrenzyBoard>(this->_screen, board.players(), board.gridSize()))
+        : std::unique_ptr<Board>(std::make_unique<ClassicBoard>(this->_screen, board.players()));
+
+    for (size_t i = 0; i < board.totalMarkedCells(); i++) {
+        const int cellNumber = board.markedCellNumber(i);
+        replayedBoard->applyMove(cellNumber, board.cellPlayerNumber(cellNumber));
+    }
+
+    if (board.isKeepingWindows()) replayedBoard->keepWindows();
+
+    return replayedBoard;
+}
+
+void BoardTest::_checkIncrementalState(Board const& board, std::string const& name) {
+    const int totalCells = board.gridSize() * board.gridSize();
+    const std::unique_ptr<Board> replayedBoard = this->_replay(board);
+    std::vector<int> availableCells {};
+    std::vector<int> expectedAvailableCells {};
+
+    board.readAvailableCellNumbers(availableCells);
+
+    for (int cellNumber = 0; cellNumber < totalCells; cellNumber++) {
+        if (board.cellPlayerNumber(cellNumber) == 0) expectedAvailableCells.push_back(cellNumber);
+    }
+
+    bool isListedInOrder = static_cast<int>(availableCells.size()) == board.totalAvailableCells();
+
+    for (size_t i = 0; isListedInOrder && i < availableCells.size(); i++) {
+        isListedInOrder = availableCells[i] == board.availableCellNumber(i);
+    }
+
+    std::sort(availableCells.begin(), availableCells.end());
+    this->_check(isListedInOrder, name + ": available cells listed by index");
+    this->_check(availableCells == expectedAvailableCells, name + ": available cells");
+
+    for (const std::shared_ptr<Player>& player : board.players()) {
+        const int playerNumber = player->number();
+        const ChainMap& chainMap = board.chainMap(playerNumber);
+        ChainMap foundChainMap {};
+        bool isSameChainMap = true;
+        bool isSameConnectedCell = true;
+
+        board.findChainMap(playerNumber, foundChainMap);
+
+        for (int cellNumber : expectedAvailableCells) {
+            isSameChainMap = isSameChainMap
+                && chainMap.vertical[cellNumber] == foundChainMap.vertical[cellNumber]
+                && chainMap.horizontal[cellNumber] == foundChainMap.horizontal[cellNumber]
+                && chainMap.diagonalLeft[cellNumber] == foundChainMap.diagonalLeft[cellNumber]
+                && chainMap.diagonalRight[cellNumber] == foundChainMap.diagonalRight[cellNumber];
+
+            const ConnectedCell cell = board.connectedCellByChainMap(chainMap, cellNumber);
+            const ConnectedCell foundCell = board.findConnectedCell(
+                board.rowByCellNumber(cellNumber),
+                board.columnByCellNumber(cellNumber),
+                playerNumber);
+
+            isSameConnectedCell = isSameConnectedCell
+                && cell.verticalChain == foundCell.verticalChain
+                && cell.horizontalChain == foundCell.horizontalChain
+                && cell.diagonalLeftChain == foundCell.diagonalLeftChain
+                && cell.diagonalRightChain == foundCell.diagonalRightChain
+                && cell.totalConnected == foundCell.totalConnected;
+        }
+
+        this->_check(isSameChainMap, name + ": chain map of player " + std::to_string(playerNumber));
+        this->_check(isSameConnectedCell, name + ": connected cells of player " + std::to_string(playerNumber));
+    }
+
+    if (board.isKeepingWindows()) {
+        bool isSameWindow = true;
+
+        for (int cellNumber = 0; cellNumber < totalCells; cellNumber++) {
+            isSameWindow = isSameWindow && board.markedWindow(cellNumber) == replayedBoard->markedWindow(cellNumber);
+
+            for (const std::shared_ptr<Player>& player : board.players()) {
+                isSameWindow = isSameWindow
+                    && board.playerWindow(player->number(), cellNumber)
+                        == replayedBoard->playerWindow(player->number(), cellNumber);
+            }
+        }
+
+        this->_check(isSameWindow, name + ": windows");
+    }
+
+    this->_checkSameMoves(board, *replayedBoard, name + " against its replay");
+}
+
+void BoardTest::_checkSameMoves(Board const& board, Board const& otherBoard, std::string const& name) {
+    bool isSameMoves = board.totalMarkedCells() == otherBoard.totalMarkedCells();
+
+    for (size_t i = 0; isSameMoves && i < board.totalMarkedCells(); i++) {
+        const int cellNumber = board.markedCellNumber(i);
+
+        isSameMoves = cellNumber == otherBoard.markedCellNumber(i)
+            && board.cellPlayerNumber(cellNumber) == otherBoard.cellPlayerNumber(cellNumber);
+    }
+
+    bool isSameScore = true;
+
+    for (const std::shared_ptr<Player>& player : board.players()) {
+        isSameScore = isSameScore && board.score(player->number()) == otherBoard.score(player->number());
+    }
+
+    this->_check(isSameMoves, name + ": moves");
+    this->_check(board.hash() == otherBoard.hash(), name + ": hash");
+    this->_check(isSameScore, name + ": scores");
+    this->_check(board.isCompleted() == otherBoard.isCompleted(), name + ": completion");
+}
+
+void BoardTest::_testMovesAndUndos() {
+    for (int game = 0; game < 150; game++) {
+        const std::vector<std::shared_ptr<Player>> players = this->_createPlayers(2 + this->_random.below(3));
+        const std::unique_ptr<Board> board = this->_createBoard(game % 4 != 0, players);
+        const std::string name = "moves and undos of game " + std::to_string(game);
+
+        if (game % 2 == 0) board->keepWindows();
+
+        for (int step = 0; step < 60; step++) {
+            const bool isUndoing = board->totalMarkedCells() > 0
+                && (board->isCompleted() || this->_random.below(3) == 0);
+
+            if (isUndoing) board->undoMove();
+            else board->applyMove(this->_randomAvailableCell(*board), 1 + this->_random.below(players.size()));
+
+            this->_checkIncrementalState(*board, name);
+        }
+    }
+}
+
+void BoardTest::_testSnapshots() {
+    struct TakenSnapshot {
+        BoardSnapshot snapshot;
+        //Board the snapshot was taken from, to compare the restored board against.
+        std::unique_ptr<Board> board;
+    };
+
+    for (int game = 0; game < 150; game++) {
+        const std::vector<std::shared_ptr<Player>> players = this->_createPlayers(2 + this->_random.below(3));
+        const std::unique_ptr<Board> board = this->_createBoard(game % 3 != 0, players);
+        //Restored into as well, so snapshots are restored across boards other than the one they're taken from.
+        const std::unique_ptr<Board> otherBoard = board->clone();
+        const std::string name = "snapshots of game " + std::to_string(game);
+        std::vector<TakenSnapshot> snapshots {};
+
+        if (game % 2 == 0) board->keepWindows();
+
+        for (int step = 0; step < 60; step++) {
+            const uint64_t action = this->_random.below(10);
+
+            if (action < 5 && !board->isCompleted()) {
+                board->applyMove(this->_randomAvailableCell(*board), 1 + this->_random.below(players.size()));
+            } else if (action < 7 && board->totalMarkedCells() > 0) {
+                board->undoMove();
+            } else if (action < 9 || snapshots.empty()) {
+                snapshots.push_back(TakenSnapshot { board->snapshot(), board->clone() });
+            } else {
+                const TakenSnapshot& snapshot = snapshots.at(this->_random.below(snapshots.size()));
+
+                this->_check(board->restore(snapshot.snapshot), name + ": restore");
+                this->_check(otherBoard->restore(snapshot.snapshot), name + ": restore into another board");
+                this->_checkSameMoves(*board, *snapshot.board, name + " against the snapshot");
+                this->_checkSameMoves(*otherBoard, *snapshot.board, name + " on another board against the snapshot");
+                this->_checkIncrementalState(*otherBoard, name + " on another board");
+            }
+
+            this->_checkIncrementalState(*board, name);
+        }
+    }
+}
+
+void BoardTest::_testFixedClassicBoards() {
+    for (int totalPlayers = 2; totalPlayers <= 4; totalPlayers++) {
+        const std::vector<std::shared_ptr<Player>> players = this->_createPlayers(totalPlayers);
+        const std::unique_ptr<Board> fixedBoard = ClassicBoard::create(this->_screen, players);
+        ClassicBoard board(this->_screen, players);
+        const std::string name = "fixed Classic board of " + std::to_string(totalPlayers) + " players";
+
+        this->_check(typeid(*fixedBoard) != typeid(ClassicBoard), name + ": created");
+
+        for (int game = 0; game < 300; game++) {
+            fixedBoard->reset();
+            board.reset();
+
+            for (int step = 0; step < 40; step++) {
+                const bool isUndoing = board.totalMarkedCells() > 0
+                    && (board.isCompleted() || this->_random.below(3) == 0);
+
+                if (isUndoing) {
+                    fixedBoard->undoMove();
+                    board.undoMove();
+                } else {
+                    const int cellNumber = this->_randomAvailableCell(board);
+                    const int playerNumber = 1 + this->_random.below(totalPlayers);
+
+                    this->_check(
+                        fixedBoard->applyMove(cellNumber, playerNumber) == board.applyMove(cellNumber, playerNumber),
+                        name + ": points");
+                }
+
+                this->_checkSameMoves(*fixedBoard, board, name);
+                this->_check(fixedBoard->clone()->isCompleted() == board.isCompleted(), name + ": completion of clone");
+                this->_check(fixedBoard->winner() == board.winner(), name + ": winner");
+            }
+        }
+    }
+}
+
+void BoardTest::_testGameRecords() {
+    const std::string path = (std::filesystem::temp_directory_path() / "tic-tac-toe-test.ttr").string();
+    std::vector<std::unique_ptr<Board>> boards {};
+
+    std::filesystem::remove(path);
+
+    {
+        GameRecordWriter writer(path);
+
+        for (int game = 0; game < 100; game++) {
+            const std::vector<std::shared_ptr<Player>> players = this->_createPlayers(2 + this->_random.below(4));
+            std::unique_ptr<Board> board = game % 3 != 0
+                ? this->_createBoard(true, players)
+                : ClassicBoard::create(this->_screen, players);
+            const std::string name = "game record " + std::to_string(game);
+            std::string bytes {};
+
+            board->setPlayerTurn(1 + this->_random.below(players.size()));
+
+            while (!board->isCompleted()) {
+                board->markCellByNumber(this->_randomAvailableCell(*board), board->playerTurn()->number());
+                board->togglePlayerTurn();
+            }
+
+            GameRecordFile::appendGame(bytes, *board);
+
+            const GameRecord record = GameRecordFile::readGame(
+                reinterpret_cast<const uint8_t*>(bytes.data()),
+                bytes.size(),
+                0);
+
+            this->_checkSameMoves(*record.createBoard(this->_screen), *board, name);
+            writer.write(*board);
+            boards.push_back(std::move(board));
+        }
+    }
+
+    const GameRecordReader reader(path);
+    this->_check(reader.size() == boards.size(), "game record file: total games");
+
+    for (size_t i = 0; i < std::min(reader.size(), boards.size()); i++) {
+        const GameRecord record = reader.read(i);
+        bool isSameMarkers = record.markers.size() == boards.at(i)->players().size();
+
+        for (size_t j = 0; isSameMarkers && j < record.markers.size(); j++) {
+            isSameMarkers = record.markers[j] == boards.at(i)->players().at(j)->marker();
+        }
+
+        this->_check(isSameMarkers, "game record file: markers of game " + std::to_string(i));
+        this->_checkSameMoves(*record.createBoard(this->_screen), *boards.at(i), "game record file " + std::to_string(i));
+    }
+
+    std::filesystem::remove(path);
+}
+
+}
+
+int main() {
+    try {
+        return tic_tac_toe::BoardTest(1).run() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (std::exception const& e) {
+        std::cout << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
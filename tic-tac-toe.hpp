@@ -0,0 +1,5972 @@
+// Copyright (c) 2023 robifr
+// This code is licensed under the MIT License.
+// For details, visit: https://opensource.org/licenses/MIT
+
+/**
+ * Engine of the game, its bots and the tools around them, as a single-header library within `tic_tac_toe`.
+ * Every file may include it for the declarations, while exactly one of them defines
+ * `TIC_TAC_TOE_IMPLEMENTATION` before including it to compile the definitions.
+ * The command line, game server, scripts and benchmark aren't part of it, they're in `main.cpp`.
+ */
+
+#ifndef TIC_TAC_TOE_HPP
+#define TIC_TAC_TOE_HPP
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <limits>
+#include <map>
+#include <set>
+#include <utility>
+#include <cmath>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <optional>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <fstream>
+#include <string_view>
+#include <typeinfo>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+//Statements only compiled when built with `-DINSTRUMENTATION`, otherwise they don't exist at all.
+#if defined(INSTRUMENTATION)
+#define INSTRUMENT(...) __VA_ARGS__
+#else
+#define INSTRUMENT(...)
+#endif
+
+namespace tic_tac_toe {
+
+class Board;
+class Player;
+class OpeningBook;
+class GameRecordReader;
+class Evaluator;
+
+struct TextColor {
+    static const std::string DEFAULT;
+    static const std::string CYAN;
+    //Default foreground color, as long as the other colors so they can replace each other in place.
+    static const std::string FOREGROUND;
+};
+
+/**
+ * Counts heap allocations made through the global `new`, which standard containers go through as well,
+ * to prove that playing doesn't allocate anymore once the buffers are big enough.
+ * Only counted when the implementation is compiled with `TIC_TAC_TOE_ALLOCATION_COUNTER` defined,
+ * which replaces every global `new` and `delete`, so programs embedding the engine keep their own.
+ */
+class AllocationCounter {
+public:
+    static bool isCounting();
+
+    static uint64_t total();
+
+    static void count();
+
+private:
+    static std::atomic<uint64_t> _total;
+};
+
+/**
+ * Xoshiro256** generator, far cheaper to seed and draw from than the standard engines, 
+ * and giving the same numbers on every platform. The seed is spread through SplitMix64,
+ * so any seed including zero starts from a well mixed state.
+ */
+class RandomEngine {
+public:
+    using result_type = uint64_t;
+
+    explicit RandomEngine(uint64_t seed = 0);
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /**
+     * Seed read from the random device, for when the numbers don't have to be reproducible.
+     */
+    static uint64_t entropySeed();
+
+    result_type operator()();
+
+    /**
+     * Number from zero up to given bound excluded, without the bias of a modulo.
+     * Unlike the standard distributions, it's the same on every platform.
+     */
+    uint64_t below(uint64_t bound);
+
+    void seed(uint64_t seed);
+
+private:
+    std::array<uint64_t, 4> _state {};
+
+    static uint64_t _rotateLeft(uint64_t value, int shift);
+
+    /**
+     * Full 128 bits product of both values, split into its high and low halves, 
+     * from their 32 bits halves so it doesn't need a compiler's 128 bits integer.
+     */
+    static uint64_t _multiplyHigh(uint64_t left, uint64_t right, uint64_t& low);
+};
+
+/**
+ * Latency and work of each bot move and each turn of the game loops, aggregated into histograms 
+ * shared by every thread. Work is counted by the thread doing it, and handed over to the thread 
+ * waiting on it by the thread pool, so moves searched on several threads are counted as a whole.
+ * Declared either way so every class has the same layout with or without `INSTRUMENTATION`,
+ * but only defined and recorded when the implementation is compiled with it.
+ */
+class Instrumentation {
+public:
+    struct Counters {
+        uint64_t searchedNodes;
+        //Cells ranked by bots, each of them looked up by their chains.
+        uint64_t evaluatedCells;
+        //Calls of both `findConnectedCell` and `connectedCellByChainMap`.
+        uint64_t connectedCellLookups;
+        uint64_t allocations;
+
+        Counters& operator+=(Counters const& counters);
+
+        Counters operator-(Counters const& counters) const;
+    };
+
+    /**
+     * Recorded values grouped into buckets, each power of two split into 16 of them.
+     * So percentiles are within a sixteenth of the real value, without keeping every value.
+     */
+    class Histogram {
+    public:
+        void record(uint64_t value);
+
+        uint64_t count() const;
+
+        double mean() const;
+
+        uint64_t max() const;
+
+        /**
+         * Highest value of the bucket holding given ratio of every recorded value.
+         */
+        uint64_t percentile(double ratio) const;
+
+    private:
+        static constexpr int SUB_BUCKETS = 16;
+        std::array<uint64_t, 64 * SUB_BUCKETS> _buckets {};
+        uint64_t _count = 0;
+        uint64_t _total = 0;
+        uint64_t _max = 0;
+
+        static int _bucketIndex(uint64_t value);
+
+        static uint64_t _bucketMaxValue(int index);
+    };
+
+    /**
+     * Records a bot move once it goes out of scope, with the time and work spent since it was made.
+     */
+    class MoveScope {
+    public:
+        MoveScope();
+
+        ~MoveScope();
+
+    private:
+        const std::chrono::steady_clock::time_point _startTime;
+        const Counters _startCounters;
+    };
+
+    /**
+     * Records a turn once it goes out of scope, from applying the selected move up to showing it.
+     */
+    class TurnScope {
+    public:
+        TurnScope();
+
+        ~TurnScope();
+
+    private:
+        const std::chrono::steady_clock::time_point _startTime;
+    };
+
+    /**
+     * Counters of the calling thread, which only that thread writes into.
+     */
+    static Counters& threadCounters();
+
+    static std::string summaryText();
+
+    static std::string jsonText();
+
+    /**
+     * Print the summary into the error output, so it doesn't mix with the output of the game,
+     * and write the JSON into given file unless it's empty. Recorded values are kept.
+     */
+    static void dump(std::string const& jsonPath);
+
+private:
+    static std::mutex _mutex;
+    static std::chrono::steady_clock::duration _totalMoveTime;
+    static Counters _totalCounters;
+    static Histogram _moveTimes;
+    static Histogram _searchedNodes;
+    static Histogram _evaluatedCells;
+    static Histogram _connectedCellLookups;
+    static Histogram _allocations;
+    static Histogram _turnTimes;
+    static thread_local Counters _threadCounters;
+};
+
+struct ConnectedCell {
+    int row;
+    int column;
+    int verticalChain;
+    int horizontalChain;
+    int diagonalLeftChain;
+    int diagonalRightChain;
+    int totalConnected;
+    //Given by the evaluator that ranked it, to order cells with the same total connected cells.
+    int score = 0;
+};
+
+/**
+ * Value of every cell on the grid by cell number, split into chunks of consecutive cells 
+ * which are only allocated once a non-zero value is written into them. Chunks that aren't allocated 
+ * read as zeros, so memory follows the marked area of a grid instead of its size, 
+ * while reading a cell is still two lookups without branching.
+ */
+template<typename T>
+class ChunkedCells {
+public:
+    static constexpr int CHUNK_SHIFT = 8;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+
+    ChunkedCells(size_t totalCells = 0);
+
+    ChunkedCells(ChunkedCells const& cells);
+
+    ChunkedCells(ChunkedCells&& cells) = default;
+
+    /**
+     * Chunks already allocated here are reused, so assigning cells of the same size
+     * only allocates when the other one has chunks this one doesn't.
+     */
+    ChunkedCells& operator=(ChunkedCells const& cells);
+
+    ChunkedCells& operator=(ChunkedCells&& cells) = default;
+
+    T operator[](size_t cellNumber) const;
+
+    size_t size() const;
+
+    size_t totalAllocatedChunks() const;
+
+    void set(size_t cellNumber, T value);
+
+    /**
+     * Toggle given bits of a cell, with a single lookup of its chunk.
+     */
+    void flip(size_t cellNumber, T bits);
+
+    /**
+     * Copy consecutive cells into given values, for scanning them as a contiguous row.
+     */
+    void read(size_t firstCellNumber, size_t count, T* values) const;
+
+    void write(size_t firstCellNumber, size_t count, const T* values);
+
+    /**
+     * Zero every cell, keeping allocated chunks around to be written again.
+     */
+    void reset();
+
+    /**
+     * Resize to given amount of cells, every one of them being zero.
+     */
+    void assign(size_t totalCells);
+
+private:
+    //Shared by every chunk that isn't allocated, never written into.
+    static inline std::array<T, CHUNK_SIZE> _emptyChunk {};
+    size_t _size = 0;
+    //Allocated chunks, or null for the ones that are still empty.
+    std::vector<std::unique_ptr<T[]>> _chunks;
+    //Each chunk to read from, pointing to the empty chunk when it isn't allocated.
+    std::vector<T*> _chunkCells;
+
+    T* _allocateChunk(size_t chunkIndex);
+};
+
+/**
+ * Chain length of every cell for a single player, stored row-major by cell number.
+ * Each axis is the sum of both of its opposite directions, as in `ConnectedCell`.
+ * Only cells next to a run of the player have a chain, so they're kept in chunks as well.
+ */
+struct ChainMap {
+    ChunkedCells<uint16_t> vertical;
+    ChunkedCells<uint16_t> horizontal;
+    ChunkedCells<uint16_t> diagonalLeft;
+    ChunkedCells<uint16_t> diagonalRight;
+};
+
+struct SearchOptions {
+    //Maximum amount of moves to look ahead, including the bot's own move.
+    //Looking ahead is disabled when it's one or less.
+    int maxDepth = 8;
+    //Amount of ranked cells to consider on each move, besides the obvious one.
+    int candidateLimit = 6;
+    //The deepest completed search is used once this duration has passed.
+    std::chrono::milliseconds timeBudget = std::chrono::milliseconds(200);
+    //Memory cap of the table to remember searched positions, shared by every searching thread.
+    size_t transpositionTableMegabytes = 8;
+    //Search with more than one thread when it's bigger than one.
+    int totalThreads = 1;
+    //Whether every thread searches all the cells and shares what they found through the table,
+    //instead of splitting cells to search among the threads.
+    bool isLazySmp = false;
+    //Makes the result reproducible when given, by only limiting the search with the max depth 
+    //instead of the time budget. Games played by simulations and servers are seeded with it as well.
+    std::optional<uint64_t> seed = std::nullopt;
+    //Consulted before anything else, to answer known positions straight away.
+    std::shared_ptr<const OpeningBook> openingBook = nullptr;
+    //Whether to play perfectly on Classic 3x3 grid between two players, when the book doesn't know better.
+    bool isSolvedBookUsed = true;
+    //How bots judge cells and positions, defaults to `ChainEvaluator` when it's null.
+    std::shared_ptr<const Evaluator> evaluator = nullptr;
+    //Playouts of Monte Carlo tree search on each move, which replaces looking ahead with alpha-beta 
+    //when it's bigger than zero. Still stopped by the time budget unless seeded, 
+    //though it's only reproducible with a single thread as threads race on the shared tree.
+    long monteCarloPlayouts = 0;
+    //Memory cap of each of the two node pools of Monte Carlo tree search, 
+    //as it keeps a spare one to reroot the tree into.
+    size_t monteCarloTreeMegabytes = 8;
+};
+
+class Screen : public std::enable_shared_from_this<Screen> {
+public:
+    enum RetainedTextKey { 
+        MAIN_MENU, 
+        GAME_MODE_HEADER
+    };
+
+    //Amount of latest moves shown above the score, so the frame doesn't grow along the game.
+    static constexpr size_t TOTAL_RECENT_MOVES = 5;
+
+    std::map<RetainedTextKey, std::string>& retainedText() const;
+
+    std::unique_ptr<Board> const& board() const;
+
+    void setBoard(std::unique_ptr<Board> board);
+
+    std::unique_ptr<Board> requireGameMode();
+
+    std::vector<std::shared_ptr<Player>> requirePlayers();
+
+    int requireGridSize();
+
+    void clear();
+
+    /**
+     * Start composing a frame which overwrites the previous one from the top of the screen,
+     * instead of clearing the screen and printing everything all over again.
+     */
+    void beginFrame();
+
+    /**
+     * Append a section to the frame. It's skipped by moving the cursor past it 
+     * when the previous frame had the same section at the same line.
+     */
+    void appendFrameSection(std::string const& text);
+
+    /**
+     * Append the grid to the frame, only re-printing its changed cells when it stays on the same line.
+     */
+    void appendFrameGrid(Board const& board);
+
+    /**
+     * Append the game header, history, score and grid of given board.
+     */
+    void appendGameFrame(Board const& board);
+
+    /**
+     * Write the whole frame at once, erasing anything left from the previous frame below it.
+     */
+    void writeFrame();
+
+private:
+    struct FrameSection {
+        std::string text;
+        int line;
+    };
+
+    mutable std::map<RetainedTextKey, std::string> _retainedText {};
+    std::unique_ptr<Board> _board = nullptr;
+    //Reused by every frame, so composing them doesn't allocate once it's big enough.
+    std::string _frame {};
+    //Sections of the previous frame, replaced by the current ones as they're appended.
+    std::vector<FrameSection> _frameSections {};
+    size_t _totalFrameSections = 0;
+    //Position of the screen the next section starts at, starting from one.
+    int _frameLine = 1;
+    int _frameColumn = 1;
+    //Whether the cursor has yet to be moved past the skipped sections.
+    bool _isFrameCursorBehind = false;
+
+    void _moveFrameCursor();
+};
+
+class Player {
+public:
+    Player(int number, std::string marker);
+
+    virtual ~Player() = default;
+
+    virtual std::string name();
+
+    /**
+     * Pick a cell to mark on given board, which is only read and never marked by the player.
+     */
+    virtual int requireCellSelection(Board const& board);
+
+    const int& number() const;
+
+    const std::string& marker() const;
+
+protected:
+    const int _number;
+    const std::string _marker;
+};
+
+/**
+ * Fixed-size table remembering values of searched positions, grouped into buckets 
+ * as big as a cache line. When a bucket is full, entries from older searches 
+ * and then the shallowest ones are replaced first.
+ */
+class TranspositionTable {
+public:
+    enum Bound : uint8_t {
+        EXACT,
+        LOWER,
+        UPPER
+    };
+
+    struct Entry {
+        int32_t value;
+        //Best cell number seen from the canonical symmetry, or `NO_CELL` when there's none.
+        uint16_t cellNumber;
+        uint8_t depth;
+        //The lowest two bits are the bound, the rest are age of the search storing it.
+        uint8_t boundAndAge;
+    };
+
+    static const uint16_t NO_CELL;
+
+    TranspositionTable(size_t megabytes);
+
+    bool probe(uint64_t key, Entry& entry) const;
+
+    void store(uint64_t key, int depth, int value, Bound bound, int cellNumber);
+
+    /**
+     * Start a new search, so entries from the previous ones are replaced first.
+     */
+    void age();
+
+private:
+    /**
+     * Key is stored XOR-ed with the entry, so a slot torn by concurrent writes 
+     * from other threads simply doesn't match any key.
+     */
+    struct Slot {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> entry;
+    };
+
+    struct alignas(64) Bucket {
+        std::array<Slot, 4> slots;
+    };
+
+    std::unique_ptr<Bucket[]> _buckets = nullptr;
+    uint64_t _bucketMask = 0;
+    uint8_t _age = 0;
+
+    static uint64_t _encodeEntry(Entry const& entry);
+
+    static Entry _decodeEntry(uint64_t data);
+};
+
+/**
+ * Nodes of Monte Carlo tree search, taken from a pool allocated once and shared by every searching thread.
+ * Children of a node are taken at once so they're next to each other. Between moves, the subtree 
+ * of the position that's reached is moved into a spare pool, so the rest is dropped without freeing any node.
+ */
+class MonteCarloTree {
+public:
+    enum State : uint8_t {
+        LEAF,
+        EXPANDING,
+        EXPANDED
+    };
+
+    struct Node {
+        int32_t firstChild;
+        int32_t totalChildren;
+        //Cell marked to reach this node, and the player who marked it.
+        int32_t cellNumber;
+        uint8_t playerNumber;
+        std::atomic<uint8_t> state;
+        //Counted as soon as a playout passes through, before its reward is known. So other threads 
+        //see it as a loss until then, which spreads them to other nodes.
+        std::atomic<int32_t> visits;
+        //Rewards for the player who marked the cell, scaled by `REWARD_SCALE`.
+        std::atomic<int64_t> totalReward;
+    };
+
+    static constexpr int64_t REWARD_SCALE = int64_t(1) << 20;
+    static constexpr int32_t ROOT = 0;
+
+    MonteCarloTree(size_t megabytes);
+
+    Node& node(int32_t index) const;
+
+    size_t size() const;
+
+    /**
+     * Whether an allocation ran out of nodes, after which the tree stops growing until it's cleared or rerooted.
+     */
+    bool isFull() const;
+
+    /**
+     * Start over from a single root, reached by given player marking given cell.
+     */
+    void clear(int cellNumber, int playerNumber);
+
+    /**
+     * Take consecutive nodes for the children of a node, or -1 when there aren't enough of them left.
+     */
+    int32_t allocate(int32_t totalNodes);
+
+    /**
+     * Make given node the new root, dropping everything outside of its subtree.
+     */
+    void reroot(int32_t index);
+
+private:
+    const size_t _capacity;
+    std::unique_ptr<Node[]> _nodes;
+    std::unique_ptr<Node[]> _spareNodes;
+    std::atomic<size_t> _totalNodes { 0 };
+    std::atomic<bool> _isFull { false };
+
+    static void _copyNode(Node const& source, Node& target);
+};
+
+/**
+ * Threads waiting to run a batch of tasks. Tasks are dealt evenly into each thread's own queue,
+ * where they take from the front of their queue and steal from the back of the others once it's empty.
+ */
+class ThreadPool {
+public:
+    ThreadPool(int totalThreads);
+
+    ~ThreadPool();
+
+    int totalThreads() const;
+
+    /**
+     * Run the task for each index up to total tasks, blocking until every one of them is done.
+     * Index of the thread running it is passed as well, to access per-thread data.
+     */
+    void run(int totalTasks, std::function<void(int taskIndex, int threadIndex)> const& task);
+
+private:
+    struct TaskQueue {
+        //Kept as a vector with the front being an index, so it's reused across runs without allocating.
+        std::vector<int> taskIndexes;
+        size_t front = 0;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> _taskQueues;
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _runCondition;
+    std::condition_variable _doneCondition;
+    const std::function<void(int, int)>* _task = nullptr;
+    int _totalRuns = 0;
+    int _remainingTasks = 0;
+    bool _isStopping = false;
+    //Work counted by the threads while running tasks, handed over to the thread that runs them.
+    //Only counted when instrumented, but kept either way so the layout doesn't depend on it.
+    Instrumentation::Counters _taskCounters {};
+
+    void _work(int threadIndex);
+
+    bool _takeTask(int threadIndex, int& taskIndex);
+};
+
+/**
+ * Cells to play straight away on known positions, keyed by the canonical hash and the player turn.
+ * A book either covers every position of a game like a solved one does, or only its openings.
+ * 
+ * Saved books are laid out in little-endian as follows,
+ *    magic "TTTB", version (u8), is classic (u8), grid size (u16), total players (u16), 
+ *    total entries (u64), followed by each entry of key (u64) and cell number (u16).
+ * Cell numbers are taken from the grid seen from the symmetry the canonical hash is taken from.
+ */
+class OpeningBook {
+public:
+    OpeningBook(bool isClassic, int gridSize, int totalPlayers);
+
+    /**
+     * Look every move ahead until the end of the game, remembering the best cell of each position 
+     * for both players to start, where faster win is better. Only works with Classic board 
+     * between two players, and quickly gets out of hand for anything bigger than 3x3 grid.
+     */
+    static OpeningBook solve(Board& board);
+
+    /**
+     * Solved book for Classic 3x3 grid, only solved once on first use.
+     */
+    static std::shared_ptr<const OpeningBook> const& solvedClassic();
+
+    /**
+     * Book of the first given amount of moves of every game in the record, played by its winner 
+     * or by every player on a draw. Each position takes the cell marked the most there, the lowest one 
+     * on a tie, so the book is the same whichever order the games are recorded in. 
+     * Games of other mode, grid size or players than the first one are skipped, the rest are counted.
+     */
+    static OpeningBook build(GameRecordReader const& reader, size_t totalMoves, size_t& totalGames);
+
+    /**
+     * Read a saved book, throws when it's invalid or any of its cells are beyond its grid.
+     */
+    static OpeningBook load(std::string const& path);
+
+    void save(std::string const& path) const;
+
+    /**
+     * Whether positions of this book can be found on given board.
+     */
+    bool fits(Board const& board) const;
+
+    /**
+     * Cell of given position, only found when it's still available on the board.
+     */
+    bool find(Board const& board, int playerNumber, int& cellNumber) const;
+
+    size_t size() const;
+
+private:
+    static constexpr char MAGIC[] = "TTTB";
+    static constexpr uint8_t VERSION = 1;
+
+    const bool _isClassic;
+    const int _gridSize;
+    const int _totalPlayers;
+    std::unordered_map<uint64_t, uint16_t> _cells {};
+
+    static uint64_t _key(Board const& board, int playerNumber, int& symmetry);
+
+    int _solve(Board& board, int playerNumber, std::unordered_map<uint64_t, int>& values);
+};
+
+/**
+ * Judgement of bots on which cells are worth marking and how good a position is, 
+ * so it can be swapped without touching the search. Shared by every bot using it, 
+ * hence it has to be safe to call from many threads at once.
+ */
+class Evaluator {
+public:
+    //Value of a single point, so the leaf value has room to tell apart positions gaining the same points.
+    //Searches scale the points of each move by it as well, to add them up with leaf values.
+    static constexpr int POINT_VALUE = 100;
+
+    virtual ~Evaluator() = default;
+
+    /**
+     * Either 'chain' or 'pattern'.
+     */
+    static std::shared_ptr<const Evaluator> create(std::string const& name);
+
+    virtual std::string name() const = 0;
+
+    /**
+     * Rank given cells for given player, best first. Cells are ordered by their total connected cells 
+     * before their score, as bots block others based on points of their best cells.
+     */
+    virtual void rankCells(
+        Board const& board, 
+        int playerNumber, 
+        std::vector<int> const& cellNumbers, 
+        std::vector<ConnectedCell>& rankedCells) const = 0;
+
+    /**
+     * Value of given board for given player, when there's no more move to look ahead.
+     * Defaults to half the points of their best cell, as it's not guaranteed they can take it.
+     */
+    virtual int evaluateLeaf(Board const& board, int playerNumber) const;
+
+    /**
+     * Whether it reads windows of the board, so boards only keep them for bots that need them.
+     */
+    virtual bool isReadingWindows() const;
+
+protected:
+    static void _sortRankedCells(std::vector<ConnectedCell>& rankedCells);
+};
+
+/**
+ * Scores cells by their chains summed, so cells next to more marked cells come first.
+ */
+class ChainEvaluator : public Evaluator {
+public:
+    std::string name() const override;
+
+    void rankCells(
+        Board const& board, 
+        int playerNumber, 
+        std::vector<int> const& cellNumbers, 
+        std::vector<ConnectedCell>& rankedCells) const override;
+};
+
+/**
+ * Scores cells by the lines they're in, whether they're open or blocked on both ends, 
+ * and whether a cell makes more than one threat at once. Cells within a few steps 
+ * along each axis are taken from the windows the board keeps up to date, 
+ * which are looked up from tables built once instead of walking each direction on every call.
+ */
+class PatternEvaluator : public Evaluator {
+public:
+    std::string name() const override;
+
+    void rankCells(
+        Board const& board, 
+        int playerNumber, 
+        std::vector<int> const& cellNumbers, 
+        std::vector<ConnectedCell>& rankedCells) const override;
+
+    /**
+     * Half the points of the best ranked cell the same way as others, along with its score, 
+     * kept below half a point so the score only tells apart leaves gaining the same points.
+     */
+    int evaluateLeaf(Board const& board, int playerNumber) const override;
+
+    bool isReadingWindows() const override;
+
+private:
+    //Cells read on each side of a cell along every axis, the same as the board keeps.
+    static constexpr int WINDOW_RADIUS = 4;
+    //Every side is encoded by its run and its span, each from zero up to the radius.
+    static constexpr int TOTAL_SIDE_SHAPES = (WINDOW_RADIUS + 1) * (WINDOW_RADIUS + 1);
+    //Added when a cell threatens a line of three along more than one axis, as only one can be blocked.
+    static constexpr int DOUBLE_THREAT_VALUE = 40;
+
+    /**
+     * Shape of each side by its blocked cells at the low bits and own cells at the high bits, 
+     * made of the amount of own cells running from the nearest one, and the amount of cells 
+     * until the first blocked one. Blocked cells are marked by anyone or outside the grid.
+     */
+    static std::array<uint8_t, 1 << (2 * WINDOW_RADIUS)> const& _sideShapes();
+
+    /**
+     * Value of marking a cell between two sides by their shapes, shifted by one bit 
+     * to tell whether it's a threat, a line of two or more with an open end.
+     */
+    static std::array<uint16_t, TOTAL_SIDE_SHAPES * TOTAL_SIDE_SHAPES> const& _lineValues();
+
+    /**
+     * Lines through given available cell summed, along with whether it makes a double threat.
+     */
+    static int _cellScore(Board const& board, int playerNumber, int cellNumber, int row, int column);
+
+    static void _requireWindows(Board const& board);
+};
+
+class Bot : public Player {
+public:
+    Bot(int number, std::string marker, SearchOptions searchOptions = SearchOptions {});
+
+    std::string name() override;
+
+    int requireCellSelection(Board const& board) override;
+
+    std::shared_ptr<const Evaluator> const& evaluator() const;
+
+private:
+    /**
+     * Buffers reused by every move of a searching thread, so searching doesn't allocate 
+     * once they're big enough. Only buffers of candidate cells are kept per depth, 
+     * as the others are done with before searching deeper.
+     */
+    struct SearchScratch {
+        std::vector<std::vector<int>> candidateCellsByDepth;
+        std::vector<int> rootCells;
+        //Value of each root cell when they're searched in parallel.
+        std::vector<int> rootValues;
+        //Listed once for ranking them for each player, as the board only lists them on demand.
+        std::vector<int> availableCells;
+        std::vector<ConnectedCell> rankedCells;
+        std::vector<ConnectedCell> playerCells;
+        std::vector<ConnectedCell> playerToBlockCells;
+        //Nodes of the tree a playout passes through, from the root.
+        std::vector<int32_t> monteCarloPath;
+        //Cells sampled to pick from on each move of a rollout.
+        std::vector<int> rolloutCells;
+    };
+
+    struct SearchContext {
+        //Copy of the played board owned by the searching thread, where moves are looked ahead.
+        Board& board;
+        long searchedNodes;
+        SearchScratch& scratch;
+    };
+
+    const SearchOptions _searchOptions;
+    const std::shared_ptr<const Evaluator> _evaluator;
+    std::unique_ptr<TranspositionTable> _transpositionTable = nullptr;
+    std::unique_ptr<ThreadPool> _threadPool = nullptr;
+    //Board and scratch of each searching thread, kept between moves to be overwritten by the next one.
+    std::vector<std::unique_ptr<Board>> _searchBoards {};
+    std::vector<SearchScratch> _searchScratches {};
+    std::chrono::steady_clock::time_point _searchDeadline {};
+    std::atomic<bool> _isSearchTimeout { false };
+    std::unique_ptr<MonteCarloTree> _monteCarloTree = nullptr;
+    //Cell and player number of every move up until the root of the tree, to find the root again on the next move.
+    std::vector<std::pair<int, int>> _monteCarloRootMoves {};
+
+    //Moves of every player played out after leaving the tree, as scores by then are close enough 
+    //on big grids while playing out the rest would take most of the time.
+    static constexpr int ROLLOUT_ROUNDS = 4;
+    //Cells randomly sampled on each move of a rollout, where the best ranked one is marked.
+    static constexpr int ROLLOUT_SAMPLES = 4;
+    //A leaf is expanded once it's been visited this many times, so nodes aren't spent on each playout.
+    static constexpr int EXPANSION_VISITS = 2;
+    static constexpr double EXPLORATION = 1.4;
+
+    /**
+     * Pick a cell by only evaluating current move, either to chain or to block others.
+     */
+    int _findHeuristicCell(Board const& board);
+
+    /**
+     * Look ahead the next moves with alpha-beta pruning, by iteratively deepening 
+     * until the time budget runs out. Every other player is assumed to play against this bot,
+     * so the same search works for two players as well as for more.
+     */
+    int _searchBestCell(Board const& board, int heuristicCell);
+
+    /**
+     * Root cells are reordered as they're searched, with the best one so far coming first.
+     */
+    int _searchIteratively(SearchContext& context, std::vector<int>& rootCells);
+
+    /**
+     * Split root cells among the threads on each depth, 
+     * as each of them are searched with full window to get their exact value.
+     */
+    int _searchRootInParallel(std::vector<int>& rootCells);
+
+    /**
+     * Every thread searches iteratively on their own board while sharing one table.
+     * Helper threads search in different order to fill the table with positions the main thread 
+     * will likely reach, and they're stopped as soon as the main thread is finished.
+     */
+    int _searchLazySmp(std::vector<int> const& rootCells);
+
+    /**
+     * Grow a tree by playing out games from its leaves, where each player is assumed to pick 
+     * their most rewarding cell. The tree is reused between moves and shared by every thread, 
+     * then the most visited cell from the root is picked.
+     */
+    int _searchMonteCarlo(Board const& board, int heuristicCell);
+
+    /**
+     * Keep the subtree of the current position from the previous search, or start over when it's not found.
+     */
+    void _reuseMonteCarloTree(Board const& board);
+
+    /**
+     * Select down the tree, expand the leaf that's reached, then roll out a few rounds 
+     * and reward every node passed through by the scores, before reverting every move.
+     */
+    void _playOutMonteCarlo(SearchContext& context, RandomEngine& random);
+
+    /**
+     * Take unvisited children first in the order they're ranked, then the ones with highest upper confidence bound.
+     */
+    int32_t _selectMonteCarloChild(MonteCarloTree::Node const& node) const;
+
+    bool _expandMonteCarloNode(MonteCarloTree::Node& node, std::vector<int> const& cellNumbers, int playerNumber);
+
+    /**
+     * Value of a move for this bot, which is the points it gained subtracted 
+     * by points gained from the others, after searching a number of moves after it.
+     */
+    int _searchMove(SearchContext& context, int cellNumber, int playerNumber, int depth, int alpha, int beta);
+
+    int _searchMinimax(SearchContext& context, int playerNumber, int depth, int alpha, int beta);
+
+    /**
+     * Estimate the value when there's no more move to look ahead, from the side of this bot.
+     */
+    int _evaluateSearchLeaf(Board const& board, int playerNumber);
+
+    /**
+     * Append the best ranked cells of given player to the candidates, 
+     * alongside ranked cells of the most threatening player to block.
+     */
+    void _findCandidateCells(
+        Board const& board, 
+        int playerNumber, 
+        std::vector<int>& candidateCells, 
+        SearchScratch& scratch);
+
+    /**
+     * Copy given board into the board of each searching thread, 
+     * only cloning it when the previous one is from another game.
+     */
+    void _prepareSearchBoards(Board const& board, int totalThreads);
+
+    /**
+     * Reserve scratch of each searching thread to fit the moves of given board.
+     */
+    void _prepareSearchScratches(Board const& board, int totalScratches);
+
+    //Times ranking on its own, which is otherwise only reached through a whole turn.
+    friend class Benchmark;
+
+    void _rankAvailableCells(
+        Board const& board,
+        Player const& player, 
+        std::vector<int> const& availableCellNumbers,
+        std::vector<ConnectedCell>& rankedCells);
+
+    /**
+     * Compute which one from two have shortest turn distance from this bot.
+     * Assuming we compares second and fourth player,
+     *    { p1, p2, bot, p4, p5 }
+     * The one have shortest turn distance from this bot is fourth player,
+     * with second player have longest turn.
+     */
+    Player const& _compareNextTurn(Player const& player1, Player const& player2);
+};
+
+/**
+ * State of a board that never changes once it's taken, cheap to take and to keep many of. 
+ * Moves are kept as a chain of segments shared with the snapshots taken before it, 
+ * so snapshots branching from the same game only hold the moves they don't have in common.
+ * Restoring one only reverts and marks the moves that differ from the board.
+ */
+class BoardSnapshot {
+public:
+    size_t totalMoves() const;
+
+    /**
+     * Number of player whose turn it is, or zero when no one has been picked yet.
+     */
+    int playerTurnNumber() const;
+
+private:
+    friend class Board;
+
+    struct Move {
+        int cellNumber;
+        int playerNumber;
+    };
+
+    struct Segment {
+        std::shared_ptr<const Segment> parent;
+        //Amount of moves that come before this segment.
+        size_t firstMove;
+        std::vector<Move> moves;
+    };
+
+    std::shared_ptr<const Segment> _segment = nullptr;
+    int _playerTurnNumber = 0;
+    RandomEngine _engine {};
+    //Kind of board it's taken from, so it's only restored into the same kind.
+    const std::type_info* _boardType = nullptr;
+    int _gridSize = 0;
+    size_t _totalPlayers = 0;
+
+    /**
+     * Amount of leading moves two chains have in common, by finding their latest common segment.
+     */
+    static size_t _totalCommonMoves(Segment const* segment, Segment const* otherSegment);
+};
+
+class Board {
+public:
+    //Cells kept on each side of a cell along every direction by `markedWindow`.
+    static constexpr int WINDOW_RADIUS = 4;
+
+    Board(
+        std::shared_ptr<Screen> const screen, 
+        const std::vector<std::shared_ptr<Player>> players, 
+        int gridSize);
+
+    virtual ~Board() = default;
+
+    virtual bool isCompleted() const = 0;
+
+    /**
+     * Copy of this board and its state, still sharing the same players.
+     */
+    virtual std::unique_ptr<Board> clone() const = 0;
+
+    /**
+     * Overwrite the state of this board with given one, reusing the memory this board already has. 
+     * Returns false without copying anything when they're not the same kind of board 
+     * with the same players and grid size.
+     */
+    virtual bool copyFrom(Board const& board);
+
+    const std::vector<std::shared_ptr<Player>>& players() const;
+
+    int gridSize() const;
+
+    const std::shared_ptr<Player>& playerTurn() const;
+
+    int columnByCellNumber(int cellNumber) const;
+
+    int rowByCellNumber(int cellNumber) const;
+
+    int cellNumberByPosition(int row, int column) const;
+
+    /**
+     * Amount of cells that haven't been marked yet.
+     */
+    int totalAvailableCells() const;
+
+    /**
+     * Cell that hasn't been marked yet at given index below `totalAvailableCells`, 
+     * so one can be picked without listing every other. Marking a cell moves the last one into its index.
+     * Kept up to date by marking and resetting the board, instead of rescanning the grid.
+     */
+    int availableCellNumber(int index) const;
+
+    /**
+     * Replace given cell numbers with the unordered ones that haven't been marked yet.
+     */
+    void readAvailableCellNumbers(std::vector<int>& cellNumbers) const;
+
+    bool isCellAvailable(int cellNumber) const;
+
+    /**
+     * Number of player who marked given cell, or zero when it's still available.
+     */
+    int cellPlayerNumber(int cellNumber) const;
+
+    size_t totalMarkedCells() const;
+
+    /**
+     * Cell marked by given move, counted from the first move of the game.
+     */
+    int markedCellNumber(size_t moveIndex) const;
+
+    ConnectedCell findConnectedCell(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    /**
+     * Batched version of `findConnectedCell` without chain limit, 
+     * computing chains of every cell on the grid in two passes over the rows.
+     * Chains of marked cells aren't meaningful and should be ignored.
+     */
+    void findChainMap(int targetPlayerNumber, ChainMap& chainMap) const;
+
+    /**
+     * Chains of every cell for given player, kept up to date whenever a cell is marked.
+     * Only chains of available cells are maintained.
+     */
+    const ChainMap& chainMap(int playerNumber) const;
+
+    ConnectedCell connectedCellByChainMap(ChainMap const& chainMap, int cellNumber) const;
+
+    /**
+     * Start keeping windows of every cell up to date whenever a cell is marked, the same way 
+     * as chain maps are, built from the cells marked so far. Boards keep them from the start 
+     * when any of their bots has an evaluator reading them, as they slow every move down.
+     */
+    void keepWindows();
+
+    bool isKeepingWindows() const;
+
+    /**
+     * Marked cells around given cell as a nibble for each direction, of the cells from the nearest one 
+     * at the lowest bit. Directions go down, up, right, left, down-right, up-left, down-left and up-right, 
+     * so each axis takes a byte from its forward side. Cells outside the grid are never marked.
+     * Zero for every cell unless the board is keeping its windows.
+     */
+    uint32_t markedWindow(int cellNumber) const;
+
+    /**
+     * Same as `markedWindow`, only including cells marked by given player.
+     */
+    uint32_t playerWindow(int playerNumber, int cellNumber) const;
+
+    std::string scoreText() const;
+
+    /**
+     * Grid with cell numbers in place of empty cells, where chained cells are highlighted.
+     * Kept rendered, only replacing cells that are changed by marking them.
+     */
+    const std::string& gridLayoutText() const;
+
+    /**
+     * Append text to bring the grid printed at given line of the screen (starting from one) up to date,
+     * leaving the cursor on the line right after it. Only cells changed since the previous call 
+     * are re-printed when the grid was printed at the same line, otherwise it's printed as a whole.
+     */
+    void appendGridRenderText(std::string& text, int line) const;
+
+    std::string playerTurnText() const;
+
+    /**
+     * Latest moves in the order they were made, or every one of them when it's not limited.
+     * Taken from the marked cells, so there's no need to keep the history elsewhere.
+     */
+    std::string moveHistoryText(size_t totalMoves = std::numeric_limits<size_t>::max()) const;
+
+    std::string resultText() const;
+
+    /**
+     * Player with the highest score, or null when the highest score is shared.
+     */
+    std::shared_ptr<Player> winner() const;
+
+    bool markCellByNumber(int cellNumber, int playerNumber);
+
+    /**
+     * Mark an available cell without validating it, so it can be reverted with `undoMove`.
+     * Returns the points gained by the move, which are added into the player score.
+     */
+    virtual int applyMove(int cellNumber, int playerNumber);
+
+    /**
+     * Revert the latest applied move along with the points it gained. Moves have to be reverted
+     * in the reverse order they were applied, because chains of marked cell are only restored that way.
+     */
+    virtual void undoMove();
+
+    int score(int playerNumber) const;
+
+    /**
+     * Zobrist hash of the marked cells, updated on each move.
+     */
+    uint64_t hash() const;
+
+    /**
+     * The smallest hash among every rotation and reflection of the grid, 
+     * so positions that are symmetrical to each other share the same hash.
+     * Index of the symmetry it's taken from is written into `symmetry`,
+     * which is always zero when the board doesn't fold its symmetries.
+     */
+    uint64_t canonicalHash(int& symmetry) const;
+
+    /**
+     * Map cell number into the grid rotated or reflected by given symmetry.
+     */
+    int symmetricCellNumber(int cellNumber, int symmetry) const;
+
+    /**
+     * Reverse of `symmetricCellNumber`.
+     */
+    int cellNumberBySymmetry(int symmetricCellNumber, int symmetry) const;
+
+    /**
+     * Random-like key for given player marking given cell, 
+     * or for their turn when the cell number is negative.
+     */
+    static uint64_t zobristKey(int cellNumber, int playerNumber);
+
+    virtual void reset();
+
+    /**
+     * Take the current state, sharing the moves it has in common with the latest snapshot taken or restored.
+     * Only moves marked since then are copied.
+     */
+    BoardSnapshot snapshot() const;
+
+    /**
+     * Go back or forth to given snapshot, by only reverting moves it doesn't have in common with this board 
+     * and marking the rest of its moves. Returns false without changing anything when it's taken 
+     * from another kind of board, or from a board with a different grid size or number of players.
+     */
+    bool restore(BoardSnapshot const& snapshot);
+
+    void togglePlayerTurn();
+
+    /**
+     * Hand the turn to given player instead of picking it, from which `togglePlayerTurn` carries on.
+     */
+    void setPlayerTurn(int playerNumber);
+
+    /**
+     * Random numbers of the game, drawn by the board and the bots playing on it.
+     * Drawing doesn't change the state of the game, so it's handed out by a const board as well.
+     */
+    RandomEngine& random() const;
+
+    /**
+     * Make random picks of the games played on this board reproducible, which are otherwise seeded 
+     * by the random device. The sequence carries on through resets, rather than restarting each game.
+     */
+    void seed(uint64_t seed);
+
+    int requireGridSelection() const;
+
+    bool requireRematch();
+
+protected:
+    std::weak_ptr<Screen> const _screen;
+    const std::vector<std::shared_ptr<Player>> _players;
+    const int _gridSize;
+    /**
+     * Flattened row-major grid, where each cell holds the number of player who marked it,
+     * or zero when it's still empty. Markers are only looked up when rendering the grid.
+     * Kept in chunks, so big grids don't take memory for the area that's never marked.
+     */
+    ChunkedCells<uint8_t> _grid;
+    /**
+     * Available cells are the leading ones of an ordering of every cell, up to the total.
+     * Each index stores its cell as an offset from the index, and each cell its index the same way,
+     * so only the cells swapped out of their place by marking take chunks, while the rest read zero.
+     */
+    int _totalAvailableCells = 0;
+    ChunkedCells<int> _availableCellOffsets;
+    //Offset of each cell number to its index, only valid while it's available.
+    ChunkedCells<int> _availableCellIndexOffsets;
+    //Chain map of each player, indexed by their number - 1.
+    std::vector<ChainMap> _chainMaps;
+    bool _isKeepingWindows = false;
+    //Both empty until windows are kept, so boards that never read them don't take their chunk tables.
+    ChunkedCells<uint32_t> _markedWindows;
+    //Indexed by player number - 1.
+    std::vector<ChunkedCells<uint32_t>> _playerWindows;
+    struct MarkedCell {
+        int cellNumber;
+        int points;
+    };
+
+    //Cells in the order they were marked, to revert them later.
+    std::vector<MarkedCell> _markedCells;
+    //Score of each player, indexed by their number - 1.
+    std::vector<int> _scores;
+    //Marked cells that gained any point, so it's known whether anyone scored without checking every score.
+    int _totalScoringMoves = 0;
+    //Amount of grid rotations and reflections folded into the hash, either one or eight.
+    int _totalSymmetries = 1;
+    //Hash of the grid seen from each symmetry, where the first one is the grid as is.
+    std::array<uint64_t, 8> _hashes {};
+    std::shared_ptr<Player> _playerTurn = nullptr;
+    mutable RandomEngine _engine;
+    //Latest snapshot taken or restored, along with the amount of its leading moves that are still marked 
+    //on this board. Moves marked after them are the only ones copied into the next snapshot.
+    mutable std::shared_ptr<const BoardSnapshot::Segment> _snapshotSegment = nullptr;
+    mutable size_t _totalSnapshotMoves = 0;
+    //Whether each cell is part of a chain, updated by marking cells instead of counting chains on each render.
+    ChunkedCells<uint8_t> _highlightedCells;
+    //Each cell takes the same amount of characters, so they can be replaced in place.
+    //Only rendered once it's printed, so boards that never are don't hold a text as big as the grid.
+    mutable std::string _gridLayout;
+    //Cells to re-print onto the screen, which isn't part of the board state.
+    mutable std::vector<int> _changedCells;
+    //Line of the screen the grid was last printed at, or zero when it has to be fully printed.
+    mutable int _renderedGridLine = 0;
+
+    int _cellWidth() const;
+
+    //Length of a rendered cell, including the color around it.
+    int _cellLayoutLength() const;
+
+    size_t _gridLayoutOffset(int cellNumber) const;
+
+    void _renderGridLayout() const;
+
+    int _availableCellIndex(int cellNumber) const;
+
+    void _placeAvailableCell(int index, int cellNumber);
+
+    /**
+     * Re-render given cell in place, unless the grid layout hasn't been rendered at all yet.
+     */
+    void _renderCell(int cellNumber) const;
+
+    /**
+     * Highlight cells of the runs passing through given marked cell, 
+     * as long as they're long enough to be chained.
+     */
+    void _highlightChainAround(int cellNumber, int playerNumber);
+
+    /**
+     * Reverse of `_highlightChainAround` once given cell is reverted, un-highlighting cells of the runs 
+     * it was part of unless they're still chained along another line.
+     */
+    void _unhighlightChainAround(int cellNumber, int playerNumber);
+
+    bool _isCellChained(int cellNumber) const;
+
+    /**
+     * Update chain maps after given cell is marked, only touching the lines passing through it.
+     * Only chains of targeted player could grow, and only at the available cell right after each end 
+     * of the run through marked cell. Other players' chains can't pass through a cell that was empty.
+     */
+    void _extendChainMap(int cellNumber, int playerNumber);
+
+    /**
+     * Revert `_extendChainMap` for the latest marked cell.
+     */
+    void _retractChainMap(int cellNumber, int playerNumber);
+
+    /**
+     * Add chain to the available cells right after each end of the run through given cell.
+     * A negative chain retracts it instead.
+     */
+    void _addChainAroundRuns(int cellNumber, int playerNumber, int sign);
+
+    /**
+     * Flip given cell within the windows of every cell around it, both when it's marked and reverted.
+     */
+    void _toggleWindows(int cellNumber, int playerNumber);
+
+    void _toggleHash(int cellNumber, int playerNumber);
+
+    /**
+     * Add chains from the previous scanned row into each cell of current row,
+     * then extend the runs of targeted player through current row for the next one to read.
+     * Vertical runs are read straight, while diagonal ones are already offset by the caller.
+     */
+    static void _scanChainRow(
+        const uint8_t* cells,
+        uint8_t targetPlayerNumber,
+        int count,
+        const uint16_t* previousVerticalRun,
+        const uint16_t* previousDiagonalLeftRun,
+        const uint16_t* previousDiagonalRightRun,
+        uint16_t* verticalRun,
+        uint16_t* diagonalLeftRun,
+        uint16_t* diagonalRightRun,
+        uint16_t* verticalChain,
+        uint16_t* diagonalLeftChain,
+        uint16_t* diagonalRightChain);
+
+    ConnectedCell _connectedCellByChains(
+        int row,
+        int column,
+        int verticalChain,
+        int horizontalChain,
+        int diagonalLeftChain,
+        int diagonalRightChain) const;
+
+    int _countChainByDirection(
+        int row, 
+        int column, 
+        int deltaRow, 
+        int deltaColumn,
+        int targetPlayerNumber,
+        int maxChain) const;
+
+    int _countCurrentTopChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countCurrentBottomChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countCurrentLeftChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countCurrentRightChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countTopLeftChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countTopRightChain(
+        int row,
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countBottomLeftChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+
+    int _countBottomRightChain(
+        int row, 
+        int column, 
+        int targetPlayerNumber,
+        int maxChain = std::numeric_limits<int>::max()) const;
+};
+
+class ClassicBoard : public Board {
+public:
+    ClassicBoard(
+        std::shared_ptr<Screen> const screen, 
+        const std::vector<std::shared_ptr<Player>> players);
+
+    static const std::string nameAndDescription();
+
+    /**
+     * Board fitting given players, specialized at compile time for the smaller grids.
+     */
+    static std::unique_ptr<Board> create(
+        std::shared_ptr<Screen> const screen, 
+        const std::vector<std::shared_ptr<Player>> players);
+
+    bool isCompleted() const override;
+
+    std::unique_ptr<Board> clone() const override;
+};
+
+/**
+ * Every line of three cells on an N x N grid as bit masks, grouped by the cells they pass through.
+ */
+template<int N>
+struct ClassicLineMasks {
+    //A cell is part of at most three lines on each of the four directions.
+    static constexpr int MAX_LINES_PER_CELL = 12;
+
+    std::array<std::array<uint32_t, MAX_LINES_PER_CELL>, N * N> byCell {};
+    std::array<int, N * N> totalByCell {};
+
+    constexpr ClassicLineMasks() {
+        //Vertical, horizontal, diagonal-left and diagonal-right.
+        const int deltaRows[] = {1, 0, 1, 1};
+        const int deltaColumns[] = {0, 1, 1, -1};
+
+        for (int row = 0; row < N; row++) {
+            for (int column = 0; column < N; column++) {
+                for (int direction = 0; direction < 4; direction++) {
+                    const int lastRow = row + deltaRows[direction] * 2;
+                    const int lastColumn = column + deltaColumns[direction] * 2;
+
+                    if (lastRow >= N || lastColumn < 0 || lastColumn >= N) continue;
+
+                    uint32_t mask = 0;
+
+                    for (int i = 0; i < 3; i++) {
+                        mask |= uint32_t(1) << ((row + deltaRows[direction] * i) * N 
+                            + column + deltaColumns[direction] * i);
+                    }
+
+                    for (int i = 0; i < 3; i++) {
+                        const int cellNumber = (row + deltaRows[direction] * i) * N 
+                            + column + deltaColumns[direction] * i;
+                        this->byCell[cellNumber][this->totalByCell[cellNumber]++] = mask;
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ * Classic board whose grid size is known at compile time, keeping marked cells of each player as bits.
+ * Since the game is over as soon as anyone connects three, only lines passing through 
+ * the latest marked cell need to be checked, each of them with a single mask.
+ */
+template<int N>
+class FixedClassicBoard : public ClassicBoard {
+public:
+    static_assert(N >= 3 && N * N <= 32, "Every cell has to fit into the bits of a mask.");
+
+    FixedClassicBoard(
+        std::shared_ptr<Screen> const screen, 
+        const std::vector<std::shared_ptr<Player>> players);
+
+    bool isCompleted() const override;
+
+    std::unique_ptr<Board> clone() const override;
+
+    bool copyFrom(Board const& board) override;
+
+    int applyMove(int cellNumber, int playerNumber) override;
+
+    void undoMove() override;
+
+    void reset() override;
+
+private:
+    static constexpr ClassicLineMasks<N> _lineMasks {};
+    //Marked cells of each player, indexed by their number - 1.
+    std::array<uint32_t, N - 1> _playerMasks {};
+};
+
+class FrenzyBoard : public Board {
+public:
+    FrenzyBoard(
+        std::shared_ptr<Screen> const screen, 
+        const std::vector<std::shared_ptr<Player>> players, 
+        int gridSize);
+
+    static const std::string nameAndDescription();
+
+    bool isCompleted() const override;
+
+    std::unique_ptr<Board> clone() const override;
+};
+
+/**
+ * Moves of a finished or ongoing game along with everything needed to set the board up again,
+ * so it can be rebuilt after being read from a record file.
+ */
+struct GameRecord {
+    bool isFrenzy = false;
+    int gridSize = 0;
+    //Indexed by player number - 1, same as the ones below.
+    std::vector<std::string> markers {};
+    std::vector<bool> isBots {};
+    int firstPlayerNumber = 1;
+    //Cells in the order they were marked, where turns go around starting from the first player.
+    std::vector<int> cellNumbers {};
+
+    /**
+     * Set up a new board and mark given amount of moves onto it, without prompting anything 
+     * from the screen. Bots search with given options. Throws when any of the moves can't be marked on the board.
+     */
+    std::unique_ptr<Board> createBoard(
+        std::shared_ptr<Screen> const screen, 
+        size_t totalMoves = std::numeric_limits<size_t>::max(),
+        SearchOptions const& searchOptions = SearchOptions {}) const;
+};
+
+/**
+ * Record files are made of a header of magic "TTTR" and version (u8), followed by games back to back.
+ * Each game starts with its length in bytes so it can be skipped without being decoded, then:
+ *    mode (u8, zero for Classic and one for Frenzy), grid size and total players,
+ *    each player of marker length, marker and whether it's a bot (u8),
+ *    first player number, total moves and cell number of each move.
+ * Every number besides the u8 ones are encoded as unsigned LEB128 varint,
+ * so a move on the grid below 128 cells only takes a single byte.
+ */
+class GameRecordFile {
+public:
+    static constexpr char MAGIC[] = "TTTR";
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = sizeof(GameRecordFile::MAGIC) - 1 + sizeof(GameRecordFile::VERSION);
+
+    static void appendVarint(std::string& bytes, uint64_t value);
+
+    /**
+     * Read a varint from given position and move it past the varint, throws when it's cut short.
+     */
+    static uint64_t readVarint(const uint8_t* bytes, size_t size, size_t& position);
+
+    /**
+     * Append a game of moves marked on given board so far, without its length.
+     */
+    static void appendGame(std::string& bytes, Board const& board);
+
+    /**
+     * Read a game from given position up to the end, without its length. Throws when it's invalid.
+     */
+    static GameRecord readGame(const uint8_t* bytes, size_t end, size_t position);
+};
+
+/**
+ * Appends games into a record file as they're finished, which can be shared between threads.
+ * Existing games are kept, as long as the file is a record file.
+ */
+class GameRecordWriter {
+public:
+    GameRecordWriter(std::string const& path);
+
+    /**
+     * Append moves marked on given board so far. Written games are buffered until `flush`.
+     */
+    void write(Board const& board);
+
+    /**
+     * Same as `write`, but with a game already encoded by `GameRecordFile::appendGame`.
+     */
+    void writeEncoded(std::string_view game);
+
+    void flush();
+
+private:
+    std::mutex _mutex;
+    std::ofstream _file;
+    //Reused by every game, so encoding them doesn't allocate once it's big enough.
+    std::string _game {};
+    std::string _gameLength {};
+
+    /**
+     * Append an encoded game after its length, while the mutex is already locked.
+     */
+    void _writeEncoded(std::string_view game);
+};
+
+/**
+ * Reads games of a record file by their index. On POSIX systems the file is mapped into memory
+ * instead of being read as a whole, so only the pages of games being read are loaded.
+ */
+class GameRecordReader {
+public:
+    GameRecordReader(std::string const& path);
+
+    GameRecordReader(GameRecordReader const&) = delete;
+
+    GameRecordReader& operator=(GameRecordReader const&) = delete;
+
+    ~GameRecordReader();
+
+    size_t size() const;
+
+    GameRecord read(size_t gameIndex) const;
+
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    //Only used when the file can't be mapped.
+    std::vector<uint8_t> _buffer {};
+    bool _isMapped = false;
+    //Position of each game right after its length, followed by the end of the file.
+    std::vector<size_t> _gameOffsets {};
+
+    void _unmap();
+};
+
+/**
+ * Positions gathered from many games to be evaluated at once, as a tensor of planes. 
+ * Each position has a plane for every player marker, starting from the player it's evaluated for 
+ * followed by the others in turn order, where a cell is one when it's marked by that player.
+ */
+struct PositionBatch {
+    int gridSize = 0;
+    int totalPlayers = 0;
+    //Shaped as positions by players by cells, flattened in that order.
+    std::vector<uint8_t> planes {};
+    //Score of every player in each position, ordered the same as their planes.
+    std::vector<int> scores {};
+
+    size_t size() const;
+
+    /**
+     * Keep the memory, so refilling the batch doesn't allocate once it's big enough.
+     */
+    void clear(int gridSize, int totalPlayers);
+
+    void append(Board const& board, int playerNumber);
+};
+
+/**
+ * Values many positions with a single call, so evaluators that are too heavy to be called 
+ * on every move of every game, such as learned ones, are paid for by the batch instead.
+ */
+class BatchEvaluator {
+public:
+    virtual ~BatchEvaluator() = default;
+
+    virtual std::string name() const = 0;
+
+    /**
+     * Value of each position for the player of its first plane, where higher is better.
+     * Each value only depends on its own position, so it's the same however positions are batched.
+     */
+    virtual void evaluate(PositionBatch const& batch, std::vector<float>& values) const = 0;
+};
+
+/**
+ * Counts lines of three along every axis that are still open for a single player, straight from the planes. 
+ * Lines with more of their cells marked are worth more, on top of the lead in score.
+ */
+class LineBatchEvaluator : public BatchEvaluator {
+public:
+    std::string name() const override;
+
+    void evaluate(PositionBatch const& batch, std::vector<float>& values) const override;
+};
+
+struct SimulationOptions {
+    //Amount of games to play back to back.
+    long totalGames = 0;
+    bool isFrenzy = false;
+    //Only used by Frenzy mode, Classic mode always expands to the number of bots.
+    int gridSize = 3;
+    int totalBots = 2;
+    //Amount of games played at the same time, each on their own thread.
+    int totalJobs = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    SearchOptions searchOptions {};
+    //Evaluator of each bot by their number, repeated when there're more bots than evaluators. 
+    //So evaluators can be played against each other, bots use the one from search options when it's empty.
+    std::vector<std::shared_ptr<const Evaluator>> evaluators {};
+    //When given, bots don't search but mark the candidate valued best by it. Each thread plays 
+    //a number of games in lockstep, gathering a position for every candidate of every game into one batch.
+    std::shared_ptr<const BatchEvaluator> batchEvaluator = nullptr;
+    //Most games each thread plays at once when they're evaluated in batches.
+    int batchSize = 64;
+};
+
+/**
+ * Plays bot-only games without rendering anything to the screen,
+ * only keeping final scores of each game to summarize them once every game is over.
+ * Games are spread across threads, where each thread plays on their own screen, board and bots.
+ */
+class Simulation {
+public:
+    /**
+     * Every finished game is written into the record writer unless it's null, in the order of their index
+     * so the record is the same however many jobs played them. Each game is written as soon as every game
+     * before it is, only holding the ones finished ahead of them.
+     */
+    Simulation(SimulationOptions options, std::shared_ptr<GameRecordWriter> recordWriter = nullptr);
+
+    void run();
+
+    std::string summaryText() const;
+
+private:
+    struct Result {
+        long totalDraws = 0;
+        //Indexed by player number - 1.
+        std::vector<long> totalWins;
+        //How many games each player finished with a given score, indexed by their number - 1.
+        std::vector<std::map<int, long>> scoreCounts;
+    };
+
+    //Everything a single thread plays with, padded so threads don't write into the same cache line.
+    struct alignas(64) Table {
+        std::shared_ptr<Screen> screen;
+        std::vector<std::shared_ptr<Player>> bots;
+        Result result;
+        //Boards of games played at once when they're evaluated in batches.
+        std::vector<std::unique_ptr<Board>> batchBoards;
+        //Ranks cells of batched games for each bot by their number - 1, which are then valued by the batch evaluator.
+        std::vector<std::shared_ptr<const Evaluator>> candidateEvaluators;
+        //Encoding of the game being recorded, reused so it doesn't allocate once it's big enough.
+        std::string recordedGame;
+    };
+
+    //Games are dealt in batches of at most this many games while they're recorded,
+    //so each thread is only a few games ahead of the next game to be written.
+    static constexpr long RECORDED_BATCH_GAMES = 64;
+    //Threads wait once this many games are finished ahead of the next one to be written,
+    //so a thread that's held up doesn't leave the others piling up games in memory.
+    static constexpr size_t MAX_PENDING_RECORDED_GAMES = 4096;
+
+    const SimulationOptions _options;
+    const std::shared_ptr<GameRecordWriter> _recordWriter;
+    Result _result;
+    std::chrono::steady_clock::duration _elapsedTime {};
+    //Made by every thread while playing, excluding setting up the tables.
+    uint64_t _totalAllocations = 0;
+    //Index of the next game to be written, and the encoded games finished ahead of it.
+    mutable std::mutex _recordMutex;
+    mutable std::condition_variable _recordCondition;
+    mutable long _nextRecordedGame = 0;
+    mutable std::map<long, std::string> _pendingRecordedGames {};
+
+    Table _createTable() const;
+
+    /**
+     * Play games from the first index up to the last one excluded, 
+     * each seeded by their index when seeded, so they're the same however they're spread across threads.
+     */
+    void _playGames(Table& table, long firstGame, long lastGame) const;
+
+    /**
+     * Same as `_playGames`, but every game is played at once. Each round, every unfinished game 
+     * has its candidate moves applied and appended into one batch, evaluated with a single call, 
+     * and then resumed by marking its best candidate.
+     */
+    void _playBatchedGames(Table& table, long firstGame, long lastGame) const;
+
+    void _recordGame(Table& table, Board const& board, long game) const;
+};
+
+template<typename T>
+ChunkedCells<T>::ChunkedCells(size_t totalCells) { this->assign(totalCells); }
+
+template<typename T>
+ChunkedCells<T>::ChunkedCells(ChunkedCells const& cells) { *this = cells; }
+
+template<typename T>
+ChunkedCells<T>& ChunkedCells<T>::operator=(ChunkedCells const& cells) {
+    if (this == &cells) return *this;
+    if (this->_size != cells._size) this->assign(cells._size);
+
+    for (size_t i = 0; i < this->_chunks.size(); i++) {
+        if (cells._chunks[i] != nullptr) {
+            T* const chunk = this->_chunks[i] != nullptr ? this->_chunks[i].get() : this->_allocateChunk(i);
+            std::copy(cells._chunks[i].get(), cells._chunks[i].get() + CHUNK_SIZE, chunk);
+        } else if (this->_chunks[i] != nullptr) {
+            std::fill(this->_chunks[i].get(), this->_chunks[i].get() + CHUNK_SIZE, 0);
+        }
+    }
+
+    return *this;
+}
+
+template<typename T>
+T ChunkedCells<T>::operator[](size_t cellNumber) const {
+    return this->_chunkCells[cellNumber >> CHUNK_SHIFT][cellNumber & (CHUNK_SIZE - 1)];
+}
+
+template<typename T>
+size_t ChunkedCells<T>::size() const { return this->_size; }
+
+template<typename T>
+size_t ChunkedCells<T>::totalAllocatedChunks() const {
+    return std::count_if(this->_chunks.begin(), this->_chunks.end(), [](std::unique_ptr<T[]> const& chunk) {
+        return chunk != nullptr;
+    });
+}
+
+template<typename T>
+void ChunkedCells<T>::set(size_t cellNumber, T value) {
+    const size_t chunkIndex = cellNumber >> CHUNK_SHIFT;
+    T* chunk = this->_chunkCells[chunkIndex];
+
+    if (chunk == ChunkedCells::_emptyChunk.data()) {
+        //Zero is what an empty chunk already reads as.
+        if (value == 0) return;
+
+        chunk = this->_allocateChunk(chunkIndex);
+    }
+
+    chunk[cellNumber & (CHUNK_SIZE - 1)] = value;
+}
+
+template<typename T>
+void ChunkedCells<T>::flip(size_t cellNumber, T bits) {
+    const size_t chunkIndex = cellNumber >> CHUNK_SHIFT;
+    T* chunk = this->_chunkCells[chunkIndex];
+
+    if (chunk == ChunkedCells::_emptyChunk.data()) chunk = this->_allocateChunk(chunkIndex);
+
+    chunk[cellNumber & (CHUNK_SIZE - 1)] ^= bits;
+}
+
+template<typename T>
+void ChunkedCells<T>::read(size_t firstCellNumber, size_t count, T* values) const {
+    while (count > 0) {
+        const size_t offset = firstCellNumber & (CHUNK_SIZE - 1);
+        const size_t total = std::min(count, CHUNK_SIZE - offset);
+        const T* const chunk = this->_chunkCells[firstCellNumber >> CHUNK_SHIFT];
+
+        values = std::copy(chunk + offset, chunk + offset + total, values);
+        firstCellNumber += total;
+        count -= total;
+    }
+}
+
+template<typename T>
+void ChunkedCells<T>::write(size_t firstCellNumber, size_t count, const T* values) {
+    for (size_t i = 0; i < count; i++) this->set(firstCellNumber + i, values[i]);
+}
+
+template<typename T>
+void ChunkedCells<T>::reset() {
+    for (std::unique_ptr<T[]>& chunk : this->_chunks) {
+        if (chunk != nullptr) std::fill(chunk.get(), chunk.get() + CHUNK_SIZE, 0);
+    }
+}
+
+template<typename T>
+void ChunkedCells<T>::assign(size_t totalCells) {
+    if (this->_size == totalCells) {
+        this->reset();
+        return;
+    }
+
+    const size_t totalChunks = (totalCells + CHUNK_SIZE - 1) >> CHUNK_SHIFT;
+    this->_size = totalCells;
+    this->_chunks.clear();
+    this->_chunks.resize(totalChunks);
+    this->_chunkCells.assign(totalChunks, ChunkedCells::_emptyChunk.data());
+}
+
+template<typename T>
+T* ChunkedCells<T>::_allocateChunk(size_t chunkIndex) {
+    this->_chunks[chunkIndex] = std::make_unique<T[]>(CHUNK_SIZE);
+    this->_chunkCells[chunkIndex] = this->_chunks[chunkIndex].get();
+    return this->_chunkCells[chunkIndex];
+}
+template<int N>
+FixedClassicBoard<N>::FixedClassicBoard(
+    std::shared_ptr<Screen> const screen, 
+    const std::vector<std::shared_ptr<Player>> players) : 
+    ClassicBoard(screen, players) {
+    if (players.size() + 1 != N) throw std::runtime_error("Number of players doesn't fit the grid size.");
+}
+
+template<int N>
+bool FixedClassicBoard<N>::isCompleted() const {
+    if (this->_totalAvailableCells == 0) return true;
+    if (this->_markedCells.empty()) return false;
+
+    const int cellNumber = this->_markedCells.back().cellNumber;
+    const uint32_t playerMask = this->_playerMasks[this->_grid[cellNumber] - 1];
+
+    for (int i = 0; i < FixedClassicBoard::_lineMasks.totalByCell[cellNumber]; i++) {
+        const uint32_t lineMask = FixedClassicBoard::_lineMasks.byCell[cellNumber][i];
+        if ((playerMask & lineMask) == lineMask) return true;
+    }
+
+    return false;
+}
+
+template<int N>
+std::unique_ptr<Board> FixedClassicBoard<N>::clone() const { return std::make_unique<FixedClassicBoard<N>>(*this); }
+
+template<int N>
+bool FixedClassicBoard<N>::copyFrom(Board const& board) {
+    if (!ClassicBoard::copyFrom(board)) return false;
+
+    this->_playerMasks = static_cast<const FixedClassicBoard<N>&>(board)._playerMasks;
+    return true;
+}
+
+template<int N>
+int FixedClassicBoard<N>::applyMove(int cellNumber, int playerNumber) {
+    this->_playerMasks[playerNumber - 1] |= uint32_t(1) << cellNumber;
+    return ClassicBoard::applyMove(cellNumber, playerNumber);
+}
+
+template<int N>
+void FixedClassicBoard<N>::undoMove() {
+    if (!this->_markedCells.empty()) {
+        const int cellNumber = this->_markedCells.back().cellNumber;
+        this->_playerMasks[this->_grid[cellNumber] - 1] &= ~(uint32_t(1) << cellNumber);
+    }
+
+    ClassicBoard::undoMove();
+}
+
+template<int N>
+void FixedClassicBoard<N>::reset() {
+    ClassicBoard::reset();
+    this->_playerMasks.fill(0);
+}
+
+}
+
+#endif
+
+#if defined(TIC_TAC_TOE_IMPLEMENTATION) && !defined(TIC_TAC_TOE_IMPLEMENTED)
+#define TIC_TAC_TOE_IMPLEMENTED
+
+namespace tic_tac_toe {
+
+const std::string TextColor::DEFAULT = "\033[0m";
+
+const std::string TextColor::CYAN = "\033[96m";
+
+const std::string TextColor::FOREGROUND = "\033[39m";
+
+std::atomic<uint64_t> AllocationCounter::_total { 0 };
+
+bool AllocationCounter::isCounting() {
+#if defined(TIC_TAC_TOE_ALLOCATION_COUNTER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t AllocationCounter::total() { return AllocationCounter::_total.load(std::memory_order_relaxed); }
+
+void AllocationCounter::count() { 
+    AllocationCounter::_total.fetch_add(1, std::memory_order_relaxed); 
+    INSTRUMENT(Instrumentation::threadCounters().allocations++;)
+}
+
+RandomEngine::RandomEngine(uint64_t seed) { this->seed(seed); }
+
+uint64_t RandomEngine::entropySeed() {
+    std::random_device device {};
+    return static_cast<uint64_t>(device()) << 32 | device();
+}
+
+RandomEngine::result_type RandomEngine::operator()() {
+    const uint64_t result = RandomEngine::_rotateLeft(this->_state[1] * 5, 7) * 9;
+    const uint64_t shifted = this->_state[1] << 17;
+
+    this->_state[2] ^= this->_state[0];
+    this->_state[3] ^= this->_state[1];
+    this->_state[1] ^= this->_state[2];
+    this->_state[0] ^= this->_state[3];
+    this->_state[2] ^= shifted;
+    this->_state[3] = RandomEngine::_rotateLeft(this->_state[3], 45);
+    return result;
+}
+
+uint64_t RandomEngine::below(uint64_t bound) {
+    if (bound <= 1) return 0;
+
+    //Lemire's multiply and shift, rejecting the few numbers that would make lower results more likely.
+    const uint64_t threshold = -bound % bound;
+
+    while (true) {
+        uint64_t low = 0;
+        const uint64_t high = RandomEngine::_multiplyHigh((*this)(), bound, low);
+        if (low >= threshold) return high;
+    }
+}
+
+uint64_t RandomEngine::_rotateLeft(uint64_t value, int shift) { return value << shift | value >> (64 - shift); }
+
+uint64_t RandomEngine::_multiplyHigh(uint64_t left, uint64_t right, uint64_t& low) {
+    const uint64_t leftLow = left & 0xFFFFFFFFULL;
+    const uint64_t leftHigh = left >> 32;
+    const uint64_t rightLow = right & 0xFFFFFFFFULL;
+    const uint64_t rightHigh = right >> 32;
+
+    const uint64_t lowLow = leftLow * rightLow;
+    const uint64_t highLow = leftHigh * rightLow;
+    const uint64_t lowHigh = leftLow * rightHigh;
+    //Carries of the middle products into the high half, each term fitting 64 bits.
+    const uint64_t middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFULL) + (lowHigh & 0xFFFFFFFFULL);
+
+    low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+    return leftHigh * rightHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+}
+
+void RandomEngine::seed(uint64_t seed) {
+    for (uint64_t& state : this->_state) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t value = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        state = value ^ (value >> 31);
+    }
+}
+
+#if defined(INSTRUMENTATION)
+std::mutex Instrumentation::_mutex {};
+
+std::chrono::steady_clock::duration Instrumentation::_totalMoveTime {};
+
+Instrumentation::Counters Instrumentation::_totalCounters {};
+
+Instrumentation::Histogram Instrumentation::_moveTimes {};
+
+Instrumentation::Histogram Instrumentation::_searchedNodes {};
+
+Instrumentation::Histogram Instrumentation::_evaluatedCells {};
+
+Instrumentation::Histogram Instrumentation::_connectedCellLookups {};
+
+Instrumentation::Histogram Instrumentation::_allocations {};
+
+Instrumentation::Histogram Instrumentation::_turnTimes {};
+
+//Zero initialized without a constructor, so counting allocations from `new` never allocates by itself.
+thread_local Instrumentation::Counters Instrumentation::_threadCounters {};
+
+Instrumentation::Counters& Instrumentation::Counters::operator+=(Counters const& counters) {
+    this->searchedNodes += counters.searchedNodes;
+    this->evaluatedCells += counters.evaluatedCells;
+    this->connectedCellLookups += counters.connectedCellLookups;
+    this->allocations += counters.allocations;
+    return *this;
+}
+
+Instrumentation::Counters Instrumentation::Counters::operator-(Counters const& counters) const {
+    return Counters {
+        this->searchedNodes - counters.searchedNodes,
+        this->evaluatedCells - counters.evaluatedCells,
+        this->connectedCellLookups - counters.connectedCellLookups,
+        this->allocations - counters.allocations
+    };
+}
+
+void Instrumentation::Histogram::record(uint64_t value) {
+    this->_buckets[Histogram::_bucketIndex(value)]++;
+    this->_count++;
+    this->_total += value;
+    this->_max = std::max(this->_max, value);
+}
+
+uint64_t Instrumentation::Histogram::count() const { return this->_count; }
+
+double Instrumentation::Histogram::mean() const { 
+    return this->_count == 0 ? 0.0 : static_cast<double>(this->_total) / this->_count;
+}
+
+uint64_t Instrumentation::Histogram::max() const { return this->_max; }
+
+uint64_t Instrumentation::Histogram::percentile(double ratio) const {
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(ratio * this->_count));
+    uint64_t counted = 0;
+
+    for (int i = 0; i < static_cast<int>(this->_buckets.size()); i++) {
+        counted += this->_buckets[i];
+        if (counted >= rank) return std::min(this->_max, Histogram::_bucketMaxValue(i));
+    }
+
+    return this->_max;
+}
+
+int Instrumentation::Histogram::_bucketIndex(uint64_t value) {
+    //Values below the sub-buckets get a bucket of their own.
+    if (value < SUB_BUCKETS) return static_cast<int>(value);
+
+    const int highestBit = 63 - __builtin_clzll(value);
+    const int subBucket = static_cast<int>(value >> (highestBit - 4)) & (SUB_BUCKETS - 1);
+    return (highestBit - 3) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t Instrumentation::Histogram::_bucketMaxValue(int index) {
+    if (index < SUB_BUCKETS) return index;
+
+    const int shift = index / SUB_BUCKETS - 1;
+    const uint64_t subBucket = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+Instrumentation::MoveScope::MoveScope() : 
+    _startTime(std::chrono::steady_clock::now()),
+    _startCounters(Instrumentation::threadCounters()) {
+}
+
+Instrumentation::MoveScope::~MoveScope() {
+    const std::chrono::steady_clock::duration elapsedTime = std::chrono::steady_clock::now() - this->_startTime;
+    const Counters counters = Instrumentation::threadCounters() - this->_startCounters;
+    std::lock_guard<std::mutex> lock(Instrumentation::_mutex);
+
+    Instrumentation::_totalMoveTime += elapsedTime;
+    Instrumentation::_totalCounters += counters;
+    Instrumentation::_moveTimes.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsedTime).count());
+    Instrumentation::_searchedNodes.record(counters.searchedNodes);
+    Instrumentation::_evaluatedCells.record(counters.evaluatedCells);
+    Instrumentation::_connectedCellLookups.record(counters.connectedCellLookups);
+    Instrumentation::_allocations.record(counters.allocations);
+}
+
+Instrumentation::TurnScope::TurnScope() : _startTime(std::chrono::steady_clock::now()) {}
+
+Instrumentation::TurnScope::~TurnScope() {
+    const std::chrono::steady_clock::duration elapsedTime = std::chrono::steady_clock::now() - this->_startTime;
+    std::lock_guard<std::mutex> lock(Instrumentation::_mutex);
+
+    Instrumentation::_turnTimes.record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsedTime).count());
+}
+
+Instrumentation::Counters& Instrumentation::threadCounters() { return Instrumentation::_threadCounters; }
+
+std::string Instrumentation::summaryText() {
+    const std::function<std::string(std::string const&, Histogram const&)> histogramText = 
+        [](std::string const& name, Histogram const& histogram) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(24) << name << std::right 
+                << " p50 " << std::setw(10) << histogram.percentile(0.5) 
+                << "  p99 " << std::setw(10) << histogram.percentile(0.99)
+                << "  max " << std::setw(10) << histogram.max() 
+                << "  mean " << histogram.mean() << "\n";
+            return text.str();
+        };
+    std::lock_guard<std::mutex> lock(Instrumentation::_mutex);
+    const double seconds = std::chrono::duration<double>(Instrumentation::_totalMoveTime).count();
+    std::ostringstream text;
+
+    text << std::fixed << std::setprecision(1)
+        << "Bot moves: " << Instrumentation::_moveTimes.count() << ", searched " 
+        << (seconds > 0 ? Instrumentation::_totalCounters.searchedNodes / seconds : 0.0) << " nodes/s.\n"
+        << histogramText("Time (ns)", Instrumentation::_moveTimes)
+        << histogramText("Searched nodes", Instrumentation::_searchedNodes)
+        << histogramText("Evaluated cells", Instrumentation::_evaluatedCells)
+        << histogramText("Connected cell lookups", Instrumentation::_connectedCellLookups)
+        << histogramText("Allocations", Instrumentation::_allocations)
+        << "Turns: " << Instrumentation::_turnTimes.count() << ".\n"
+        << histogramText("Time (ns)", Instrumentation::_turnTimes);
+
+    return text.str();
+}
+
+std::string Instrumentation::jsonText() {
+    const std::function<std::string(Histogram const&)> histogramJson = [](Histogram const& histogram) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1) 
+            << "{\"count\": " << histogram.count()
+            << ", \"p50\": " << histogram.percentile(0.5)
+            << ", \"p99\": " << histogram.percentile(0.99)
+            << ", \"max\": " << histogram.max()
+            << ", \"mean\": " << histogram.mean() << "}";
+        return text.str();
+    };
+    std::lock_guard<std::mutex> lock(Instrumentation::_mutex);
+    const double seconds = std::chrono::duration<double>(Instrumentation::_totalMoveTime).count();
+    const Counters& totals = Instrumentation::_totalCounters;
+    std::ostringstream text;
+
+    text << std::fixed << std::setprecision(1)
+        << "{\n"
+        << "  \"botMoves\": {\n"
+        << "    \"count\": " << Instrumentation::_moveTimes.count() << ",\n"
+        << "    \"totalSeconds\": " << std::setprecision(6) << seconds << std::setprecision(1) << ",\n"
+        << "    \"nodesPerSecond\": " << (seconds > 0 ? totals.searchedNodes / seconds : 0.0) << ",\n"
+        << "    \"totalSearchedNodes\": " << totals.searchedNodes << ",\n"
+        << "    \"totalEvaluatedCells\": " << totals.evaluatedCells << ",\n"
+        << "    \"totalConnectedCellLookups\": " << totals.connectedCellLookups << ",\n"
+        << "    \"totalAllocations\": " << totals.allocations << ",\n"
+        << "    \"timeNanoseconds\": " << histogramJson(Instrumentation::_moveTimes) << ",\n"
+        << "    \"searchedNodes\": " << histogramJson(Instrumentation::_searchedNodes) << ",\n"
+        << "    \"evaluatedCells\": " << histogramJson(Instrumentation::_evaluatedCells) << ",\n"
+        << "    \"connectedCellLookups\": " << histogramJson(Instrumentation::_connectedCellLookups) << ",\n"
+        << "    \"allocations\": " << histogramJson(Instrumentation::_allocations) << "\n"
+        << "  },\n"
+        << "  \"turns\": {\n"
+        << "    \"timeNanoseconds\": " << histogramJson(Instrumentation::_turnTimes) << "\n"
+        << "  }\n"
+        << "}\n";
+
+    return text.str();
+}
+
+void Instrumentation::dump(std::string const& jsonPath) {
+    std::cerr << Instrumentation::summaryText();
+
+    if (jsonPath.empty()) return;
+
+    std::ofstream file(jsonPath, std::ios::trunc);
+    file << Instrumentation::jsonText();
+
+    if (!file) throw std::runtime_error("Failed to write metrics into '" + jsonPath + "'.");
+}
+#endif
+
+std::map<Screen::RetainedTextKey, std::string>& Screen::retainedText() const { return this->_retainedText; }
+
+std::unique_ptr<Board> const& Screen::board() const { return this->_board; }
+
+void Screen::setBoard(std::unique_ptr<Board> board) { this->_board = std::move(board); }
+
+std::unique_ptr<Board> Screen::requireGameMode() {
+    this->_retainedText[RetainedTextKey::MAIN_MENU] = 
+        "Tic-Tac-Toe\n"
+        "-----------\n"
+        "1. Classic\n"
+        "2. Frenzy\n";
+    std::unique_ptr<Board> board;
+    int gameMode = -1;
+
+    this->clear();
+    std::cout << this->_retainedText[RetainedTextKey::MAIN_MENU] << "\n";
+
+    while (true) {
+        std::string line;
+        
+        std::cout << "Select game mode: ";
+        std::getline(std::cin, line);
+        std::cout << "\n";
+
+        std::stringstream lineStream(line);
+
+        if (lineStream >> gameMode 
+            && lineStream.eof()
+            && gameMode >= 1
+            && gameMode <= 2) {
+            switch (gameMode) {
+                case 1: {
+                    this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] = 
+                        ClassicBoard::nameAndDescription();
+                    const std::vector<std::shared_ptr<Player>> players = this->requirePlayers();
+                    board = ClassicBoard::create(shared_from_this(), players);
+                    break;
+                }
+
+                case 2: {
+                    this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] = 
+                        FrenzyBoard::nameAndDescription();
+                    const int gridSize = this->requireGridSize();
+                    const std::vector<std::shared_ptr<Player>> players = this->requirePlayers(); 
+                    board = std::make_unique<FrenzyBoard>(shared_from_this(), players, gridSize);
+                    break;
+                }       	
+            }
+
+            break;
+        }
+
+        gameMode = -1;
+        this->clear();
+
+        std::cout << this->_retainedText[RetainedTextKey::MAIN_MENU]  
+            << "\n** Invalid game mode, please reselect!\n";
+    }
+
+    board->togglePlayerTurn();
+    return board;
+}
+
+std::vector<std::shared_ptr<Player>> Screen::requirePlayers() {
+    std::vector<std::shared_ptr<Player>> players {};
+
+    this->clear();
+    std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n";
+
+    while (true) {
+        std::string line;
+
+        //Requiring for number of players.
+        std::cout << "Input number of players (min 2): ";
+        std::getline(std::cin, line);
+
+        this->clear();
+        std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER];
+
+        int totalPlayers = 0;
+        std::stringstream lineStream(line);
+
+        if (!(lineStream >> totalPlayers) 
+            || !lineStream.eof() 
+            || totalPlayers < 2
+            //Each cell stores the player number within a single byte.
+            || totalPlayers > std::numeric_limits<uint8_t>::max()) {   
+            std::cout << "\n** Invalid number of players, please reinput!\n";
+            continue;
+        }
+
+        const std::function<std::string()> readyPlayersText = [&players, &totalPlayers]() {
+            std::ostringstream text;
+            std::ostringstream readyPlayersText;
+
+            for (const std::shared_ptr<Player>& player : players) {
+                readyPlayersText << player->name() << "-" << player->number()
+                    << " (" << player->marker() << ") is ready!\n";
+            }
+
+            const std::string readyPlayers = readyPlayersText.str().empty() 
+                ? "" 
+                : "\n" + readyPlayersText.str();
+            text << players.size() << "/" << totalPlayers << " Players are set.\n" << readyPlayers;
+
+            return text.str();
+        };
+        const std::function<std::string()> setupPlayerNumberText = [&players]() {
+            return "\nSetting up player-" + std::to_string(players.size() + 1) + "...\n";
+        };
+        std::set<std::string> usedMarkers {};
+
+        std::cout << "\n" << readyPlayersText() << setupPlayerNumberText();
+
+        while (true) {
+            //Requiring for player's unique marker.
+            std::cout << "Marker: (1 char) ";
+            std::getline(std::cin, line);
+
+            this->clear();
+            std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER]
+                << "\n" << readyPlayersText() << setupPlayerNumberText();
+
+            lineStream.clear();
+            lineStream.str(line);
+
+            if (line.length() != 1 //Only allow single character.
+                || usedMarkers.find(line) != usedMarkers.end()) { //Disallow using same marker.
+                std::cout << "\n** Invalid marker, please reinput!\n";
+                continue;
+            }
+
+            const std::string marker = line;
+            usedMarkers.insert(marker);
+
+            std::cout << "Marker: " << marker << "\n";
+
+            while (true) {
+                //Requiring for player's type, whether bot or human.
+                std::cout << "As a bot? (y/n): ";
+                std::getline(std::cin, line);
+
+                this->clear();
+                std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] 
+                    << "\n" << readyPlayersText() << setupPlayerNumberText() << "Marker: " << marker << "\n";
+
+                for (char& ch : line) ch = std::tolower(ch);
+
+                std::shared_ptr<Player> player;
+
+                if (line == "y" || line == "yes") {
+                    player = std::make_shared<Bot>(players.size() + 1, marker);
+
+                } else if (line == "n" || line == "no") {
+                    player = std::make_shared<Player>(players.size() + 1, marker);
+
+                } else {
+                    std::cout << "\n** Invalid player option, please reselect!\n";                 
+                    continue;
+                }
+
+                players.push_back(player);
+                break;
+            }
+
+            this->clear();
+            std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n" << readyPlayersText();
+
+            //Keep looping until every player has been created.
+            if (players.size() == totalPlayers) break;
+
+            std::cout << setupPlayerNumberText();
+        }
+
+        std::cout << "\nInput anything to start...";
+        std::getline(std::cin, line);
+        std::cout << "\n";
+        break;
+    }
+
+    return players;
+}
+
+int Screen::requireGridSize() {
+    int gridSize = 0;
+
+    this->clear();
+    std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] << "\n";
+
+    while (true) {
+        std::string line;
+        std::cout << "Input grid size (min 3): ";
+        std::getline(std::cin, line);
+        std::cout << "\n";
+
+        std::stringstream lineStream(line);
+
+        if (lineStream >> gridSize && lineStream.eof() && gridSize >= 3) break;
+
+        gridSize = 0;
+        this->clear();
+
+        std::cout << this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] 
+            << "\n** Invalid grid size, please reinput!\n";
+    }  
+
+    return gridSize;
+}
+
+void Screen::clear() { 
+    std::cout << "\033[H\033[2J\033[3J"; 
+    //Nothing from the previous frame is left on the screen.
+    this->_frameSections.clear();
+}
+
+void Screen::beginFrame() {
+    this->_frame.assign("\033[H");
+    this->_totalFrameSections = 0;
+    this->_frameLine = 1;
+    this->_frameColumn = 1;
+    this->_isFrameCursorBehind = false;
+}
+
+void Screen::appendFrameSection(std::string const& text) {
+    const int totalLines = std::count(text.begin(), text.end(), '\n');
+    const size_t lastLineStart = text.rfind('\n') == std::string::npos ? 0 : text.rfind('\n') + 1;
+    const size_t index = this->_totalFrameSections++;
+
+    if (index < this->_frameSections.size()
+        && this->_frameSections[index].line == this->_frameLine
+        && this->_frameSections[index].text == text) {
+        //Only move the cursor once something after it has to be printed.
+        this->_isFrameCursorBehind = true;
+    } else {
+        if (index >= this->_frameSections.size()) this->_frameSections.emplace_back();
+
+        this->_moveFrameCursor();
+
+        this->_frameSections[index].text = text;
+        this->_frameSections[index].line = this->_frameLine;
+
+        for (char ch : text) {
+            //Erase the rest of previous frame on each line.
+            if (ch == '\n') this->_frame += "\033[K";
+            this->_frame += ch;
+        }
+    }
+
+    this->_frameLine += totalLines;
+    this->_frameColumn = (lastLineStart == 0 ? this->_frameColumn : 1) + text.size() - lastLineStart;
+}
+
+void Screen::appendFrameGrid(Board const& board) {
+    //The grid moves the cursor by itself.
+    board.appendGridRenderText(this->_frame, this->_frameLine);
+    this->_frameLine += board.gridSize() * 2 + 1;
+    this->_frameColumn = 1;
+    this->_isFrameCursorBehind = false;
+}
+
+void Screen::appendGameFrame(Board const& board) {
+    this->appendFrameSection(this->_retainedText[RetainedTextKey::GAME_MODE_HEADER] + "\n");
+    this->appendFrameSection(board.moveHistoryText(Screen::TOTAL_RECENT_MOVES));
+    this->appendFrameSection(board.scoreText() + "\n");
+    this->appendFrameGrid(board);
+    this->appendFrameSection("\n");
+}
+
+void Screen::writeFrame() {
+    this->_moveFrameCursor();
+    this->_frame += "\033[J";
+    this->_frameSections.resize(this->_totalFrameSections);
+    //Anything printed before has to come first.
+    std::cout.flush();
+
+#if defined(__unix__) || defined(__APPLE__)
+    size_t totalWritten = 0;
+
+    while (totalWritten < this->_frame.size()) {
+        const ssize_t written = ::write(
+            STDOUT_FILENO, 
+            this->_frame.data() + totalWritten, 
+            this->_frame.size() - totalWritten);
+
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Failed to write the frame.");
+        }
+
+        totalWritten += written;
+    }
+#else
+    std::cout.write(this->_frame.data(), this->_frame.size()).flush();
+#endif
+}
+
+void Screen::_moveFrameCursor() {
+    if (!this->_isFrameCursorBehind) return;
+
+    this->_frame += "\033[" + std::to_string(this->_frameLine) + ";" + std::to_string(this->_frameColumn) + "H";
+    this->_isFrameCursorBehind = false;
+}
+
+Player::Player(int number, std::string marker) : 
+    _number(number),
+    _marker(marker) {
+}
+
+std::string Player::name() { return "Player"; }
+
+int Player::requireCellSelection(Board const& board) { return board.requireGridSelection(); }
+
+const int& Player::number() const { return this->_number; }
+
+const std::string& Player::marker() const { return this->_marker; }
+
+const uint16_t TranspositionTable::NO_CELL = std::numeric_limits<uint16_t>::max();
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    size_t totalBuckets = 1;
+
+    //Round down to a power of two, so the bucket can be picked by masking the key.
+    while (totalBuckets * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024) totalBuckets *= 2;
+
+    this->_buckets = std::make_unique<Bucket[]>(totalBuckets);
+    this->_bucketMask = totalBuckets - 1;
+
+    for (size_t i = 0; i < totalBuckets; i++) {
+        for (Slot& slot : this->_buckets[i].slots) {
+            slot.key.store(0, std::memory_order_relaxed);
+            slot.entry.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, Entry& entry) const {
+    for (const Slot& slot : this->_buckets[key & this->_bucketMask].slots) {
+        const uint64_t data = slot.entry.load(std::memory_order_relaxed);
+        if ((slot.key.load(std::memory_order_relaxed) ^ data) != key) continue;
+
+        entry = TranspositionTable::_decodeEntry(data);
+        return true;
+    }
+
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int value, Bound bound, int cellNumber) {
+    //Entries from current search are always kept over the older ones.
+    const std::function<int(const Entry&)> keepingPriority = [this](const Entry& entry) {
+        return entry.depth + ((entry.boundAndAge >> 2) == this->_age ? 256 : 0);
+    };
+    Bucket& bucket = this->_buckets[key & this->_bucketMask];
+    Slot* replacedSlot = &bucket.slots[0];
+    uint64_t replacedKey = 0;
+    Entry replacedEntry {};
+
+    for (Slot& slot : bucket.slots) {
+        const uint64_t data = slot.entry.load(std::memory_order_relaxed);
+        const uint64_t slotKey = slot.key.load(std::memory_order_relaxed) ^ data;
+        const Entry entry = TranspositionTable::_decodeEntry(data);
+
+        if (slotKey == key || slotKey == 0) {
+            replacedSlot = &slot;
+            replacedKey = slotKey;
+            replacedEntry = entry;
+            break;
+        }
+
+        if (&slot == &bucket.slots[0] || keepingPriority(entry) < keepingPriority(replacedEntry)) {
+            replacedSlot = &slot;
+            replacedKey = slotKey;
+            replacedEntry = entry;
+        }
+    }
+
+    //Don't overwrite deeper result of the same position with a shallower bound.
+    if (replacedKey == key 
+        && bound != Bound::EXACT
+        && replacedEntry.depth > depth
+        && (replacedEntry.boundAndAge >> 2) == this->_age) {
+        return;
+    }
+
+    const uint64_t data = TranspositionTable::_encodeEntry(Entry {
+        .value = value,
+        .cellNumber = cellNumber >= 0 && cellNumber < TranspositionTable::NO_CELL 
+            ? static_cast<uint16_t>(cellNumber) 
+            : TranspositionTable::NO_CELL,
+        .depth = static_cast<uint8_t>(std::min(depth, 255)),
+        .boundAndAge = static_cast<uint8_t>(this->_age << 2 | bound)
+    });
+
+    replacedSlot->entry.store(data, std::memory_order_relaxed);
+    replacedSlot->key.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::age() { this->_age = (this->_age + 1) % 64; }
+
+uint64_t TranspositionTable::_encodeEntry(Entry const& entry) {
+    static_assert(sizeof(Entry) == sizeof(uint64_t), "Entry has to fit within a single word.");
+
+    uint64_t data = 0;
+    std::memcpy(&data, &entry, sizeof(Entry));
+    return data;
+}
+
+TranspositionTable::Entry TranspositionTable::_decodeEntry(uint64_t data) {
+    Entry entry {};
+    std::memcpy(&entry, &data, sizeof(Entry));
+    return entry;
+}
+
+MonteCarloTree::MonteCarloTree(size_t megabytes) :
+    _capacity(std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Node))),
+    _nodes(std::make_unique<Node[]>(_capacity)),
+    _spareNodes(std::make_unique<Node[]>(_capacity)) {
+}
+
+MonteCarloTree::Node& MonteCarloTree::node(int32_t index) const { return this->_nodes[index]; }
+
+size_t MonteCarloTree::size() const { 
+    return std::min(this->_capacity, this->_totalNodes.load(std::memory_order_relaxed)); 
+}
+
+bool MonteCarloTree::isFull() const { return this->_isFull.load(std::memory_order_relaxed); }
+
+void MonteCarloTree::clear(int cellNumber, int playerNumber) {
+    Node& root = this->_nodes[MonteCarloTree::ROOT];
+
+    root.firstChild = -1;
+    root.totalChildren = 0;
+    root.cellNumber = cellNumber;
+    root.playerNumber = static_cast<uint8_t>(playerNumber);
+    root.state.store(State::LEAF, std::memory_order_relaxed);
+    root.visits.store(0, std::memory_order_relaxed);
+    root.totalReward.store(0, std::memory_order_relaxed);
+    this->_totalNodes.store(1, std::memory_order_relaxed);
+    this->_isFull.store(false, std::memory_order_relaxed);
+}
+
+int32_t MonteCarloTree::allocate(int32_t totalNodes) {
+    //Checked beforehand as well, so the count doesn't keep growing once the pool is full.
+    if (this->_totalNodes.load(std::memory_order_relaxed) + totalNodes > this->_capacity) {
+        this->_isFull.store(true, std::memory_order_relaxed);
+        return -1;
+    }
+
+    const size_t firstNode = this->_totalNodes.fetch_add(totalNodes, std::memory_order_relaxed);
+    if (firstNode + totalNodes <= this->_capacity) return static_cast<int32_t>(firstNode);
+
+    this->_isFull.store(true, std::memory_order_relaxed);
+    return -1;
+}
+
+void MonteCarloTree::reroot(int32_t index) {
+    size_t totalNodes = 1;
+    MonteCarloTree::_copyNode(this->_nodes[index], this->_spareNodes[MonteCarloTree::ROOT]);
+
+    //Copied breadth first, where children of each copied node are taken next to each other again.
+    for (size_t i = 0; i < totalNodes; i++) {
+        Node& node = this->_spareNodes[i];
+
+        if (node.state.load(std::memory_order_relaxed) != State::EXPANDED) continue;
+
+        for (int32_t child = 0; child < node.totalChildren; child++) {
+            MonteCarloTree::_copyNode(this->_nodes[node.firstChild + child], this->_spareNodes[totalNodes + child]);
+        }
+
+        node.firstChild = static_cast<int32_t>(totalNodes);
+        totalNodes += node.totalChildren;
+    }
+
+    std::swap(this->_nodes, this->_spareNodes);
+    this->_totalNodes.store(totalNodes, std::memory_order_relaxed);
+    this->_isFull.store(false, std::memory_order_relaxed);
+}
+
+void MonteCarloTree::_copyNode(Node const& source, Node& target) {
+    target.firstChild = source.firstChild;
+    target.totalChildren = source.totalChildren;
+    target.cellNumber = source.cellNumber;
+    target.playerNumber = source.playerNumber;
+    target.state.store(source.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    target.visits.store(source.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    target.totalReward.store(source.totalReward.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+ThreadPool::ThreadPool(int totalThreads) {
+    for (int i = 0; i < totalThreads; i++) this->_taskQueues.push_back(std::make_unique<TaskQueue>());
+    for (int i = 0; i < totalThreads; i++) this->_threads.emplace_back(&ThreadPool::_work, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_isStopping = true;
+    }
+
+    this->_runCondition.notify_all();
+    for (std::thread& thread : this->_threads) thread.join();
+}
+
+int ThreadPool::totalThreads() const { return this->_threads.size(); }
+
+void ThreadPool::run(int totalTasks, std::function<void(int taskIndex, int threadIndex)> const& task) {
+    if (totalTasks <= 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->_mutex);
+        this->_task = &task;
+        this->_remainingTasks = totalTasks;
+        this->_totalRuns++;
+
+        for (int i = 0; i < totalTasks; i++) {
+            TaskQueue& queue = *this->_taskQueues.at(i % this->_taskQueues.size());
+            std::lock_guard<std::mutex> queueLock(queue.mutex);
+            queue.taskIndexes.push_back(i);
+        }
+    }
+
+    this->_runCondition.notify_all();
+
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_doneCondition.wait(lock, [this]() { return this->_remainingTasks == 0; });
+
+    INSTRUMENT(
+        Instrumentation::threadCounters() += this->_taskCounters;
+        this->_taskCounters = Instrumentation::Counters {};
+    )
+}
+
+void ThreadPool::_work(int threadIndex) {
+    int totalRuns = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_runCondition.wait(lock, [this, &totalRuns]() { 
+                return this->_isStopping || this->_totalRuns != totalRuns; 
+            });
+
+            if (this->_isStopping) return;
+
+            totalRuns = this->_totalRuns;
+        }
+
+        int taskIndex = -1;
+
+        while (this->_takeTask(threadIndex, taskIndex)) {
+            INSTRUMENT(const Instrumentation::Counters startCounters = Instrumentation::threadCounters();)
+            (*this->_task)(taskIndex, threadIndex);
+
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            INSTRUMENT(this->_taskCounters += Instrumentation::threadCounters() - startCounters;)
+            if (--this->_remainingTasks == 0) this->_doneCondition.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::_takeTask(int threadIndex, int& taskIndex) {
+    const int totalQueues = this->_taskQueues.size();
+
+    for (int n = 0; n < totalQueues; n++) {
+        TaskQueue& queue = *this->_taskQueues.at((threadIndex + n) % totalQueues);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.front == queue.taskIndexes.size()) continue;
+
+        //Own queue is taken from the front, while the others are stolen from the back.
+        if (n == 0) {
+            taskIndex = queue.taskIndexes.at(queue.front++);
+        } else {
+            taskIndex = queue.taskIndexes.back();
+            queue.taskIndexes.pop_back();
+        }
+
+        if (queue.front == queue.taskIndexes.size()) {
+            queue.taskIndexes.clear();
+            queue.front = 0;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+OpeningBook::OpeningBook(bool isClassic, int gridSize, int totalPlayers) : 
+    _isClassic(isClassic),
+    _gridSize(gridSize),
+    _totalPlayers(totalPlayers) {
+}
+
+OpeningBook OpeningBook::solve(Board& board) {
+    if (dynamic_cast<ClassicBoard*>(&board) == nullptr || board.players().size() != 2) {
+        throw std::runtime_error("Only Classic board between two players can be solved.");
+    }
+
+    OpeningBook book(true, board.gridSize(), 2);
+    std::unordered_map<uint64_t, int> values {};
+
+    //Either player may be the one to start.
+    for (int playerNumber = 1; playerNumber <= 2; playerNumber++) book._solve(board, playerNumber, values);
+
+    return book;
+}
+
+std::shared_ptr<const OpeningBook> const& OpeningBook::solvedClassic() {
+    static const std::shared_ptr<const OpeningBook> book = []() {
+        const std::vector<std::shared_ptr<Player>> players { 
+            std::make_shared<Player>(1, "X"), 
+            std::make_shared<Player>(2, "O")
+        };
+        FixedClassicBoard<3> board(nullptr, players);
+        return std::make_shared<const OpeningBook>(OpeningBook::solve(board));
+    }();
+
+    return book;
+}
+
+OpeningBook OpeningBook::build(GameRecordReader const& reader, size_t totalMoves, size_t& totalGames) {
+    if (reader.size() == 0) throw std::runtime_error("Game record has no game to build an opening book from.");
+
+    const GameRecord firstRecord = reader.read(0);
+    const std::shared_ptr<Screen> screen = std::make_shared<Screen>();
+    const std::unique_ptr<Board> board = firstRecord.createBoard(screen, 0);
+    OpeningBook book(!firstRecord.isFrenzy, board->gridSize(), board->players().size());
+    //Times each cell is marked on every position, ordered so ties go to the lowest cell.
+    std::unordered_map<uint64_t, std::map<uint16_t, long>> cellCounts {};
+    totalGames = 0;
+
+    for (size_t i = 0; i < reader.size(); i++) {
+        const GameRecord record = reader.read(i);
+
+        if (record.isFrenzy != firstRecord.isFrenzy 
+            || record.gridSize != firstRecord.gridSize 
+            || record.markers.size() != firstRecord.markers.size()) {
+            continue;
+        }
+
+        const std::unique_ptr<Board> game = record.createBoard(screen);
+        const std::shared_ptr<Player> winner = game->winner();
+
+        board->reset();
+
+        for (size_t move = 0; move < std::min(totalMoves, game->totalMarkedCells()); move++) {
+            const int cellNumber = game->markedCellNumber(move);
+            const int playerNumber = game->cellPlayerNumber(cellNumber);
+
+            if (winner == nullptr || winner->number() == playerNumber) {
+                int symmetry = 0;
+                const uint64_t key = OpeningBook::_key(*board, playerNumber, symmetry);
+
+                cellCounts[key][board->symmetricCellNumber(cellNumber, symmetry)]++;
+            }
+
+            board->applyMove(cellNumber, playerNumber);
+        }
+
+        totalGames++;
+    }
+
+    for (const std::pair<const uint64_t, std::map<uint16_t, long>>& position : cellCounts) {
+        std::map<uint16_t, long>::const_iterator bestCell = position.second.begin();
+
+        for (std::map<uint16_t, long>::const_iterator it = bestCell; it != position.second.end(); it++) {
+            if (it->second > bestCell->second) bestCell = it;
+        }
+
+        book._cells[position.first] = bestCell->first;
+    }
+
+    return book;
+}
+
+OpeningBook OpeningBook::load(std::string const& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("Can't open opening book '" + path + "'.");
+
+    const std::function<uint64_t(int)> readNumber = [&file, &path](int totalBytes) {
+        unsigned char bytes[8] {};
+
+        if (!file.read(reinterpret_cast<char*>(bytes), totalBytes)) {
+            throw std::runtime_error("Opening book '" + path + "' is cut short.");
+        }
+
+        uint64_t number = 0;
+        for (int i = totalBytes - 1; i >= 0; i--) number = number << 8 | bytes[i];
+
+        return number;
+    };
+    char magic[4] {};
+
+    if (!file.read(magic, sizeof(magic)) 
+        || std::memcmp(magic, OpeningBook::MAGIC, sizeof(magic)) != 0
+        || readNumber(1) != OpeningBook::VERSION) {
+        throw std::runtime_error("'" + path + "' isn't a supported opening book.");
+    }
+
+    const bool isClassic = readNumber(1) != 0;
+    const int gridSize = readNumber(2);
+    const int totalPlayers = readNumber(2);
+    const uint64_t totalEntries = readNumber(8);
+    OpeningBook book(isClassic, gridSize, totalPlayers);
+
+    for (uint64_t i = 0; i < totalEntries; i++) {
+        const uint64_t key = readNumber(8);
+        const uint64_t cellNumber = readNumber(2);
+
+        if (cellNumber >= static_cast<uint64_t>(gridSize) * gridSize) {
+            throw std::runtime_error("Opening book '" + path + "' has a cell beyond its grid.");
+        }
+
+        book._cells[key] = static_cast<uint16_t>(cellNumber);
+    }
+
+    return book;
+}
+
+void OpeningBook::save(std::string const& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Can't open opening book '" + path + "'.");
+
+    const std::function<void(uint64_t, int)> writeNumber = [&file](uint64_t number, int totalBytes) {
+        for (int i = 0; i < totalBytes; i++) file.put(static_cast<char>(number >> (i * 8) & 0xFF));
+    };
+
+    file.write(OpeningBook::MAGIC, 4);
+    writeNumber(OpeningBook::VERSION, 1);
+    writeNumber(this->_isClassic ? 1 : 0, 1);
+    writeNumber(this->_gridSize, 2);
+    writeNumber(this->_totalPlayers, 2);
+    writeNumber(this->_cells.size(), 8);
+
+    for (const std::pair<const uint64_t, uint16_t>& cell : this->_cells) {
+        writeNumber(cell.first, 8);
+        writeNumber(cell.second, 2);
+    }
+
+    if (!file) throw std::runtime_error("Can't write opening book '" + path + "'.");
+}
+
+bool OpeningBook::fits(Board const& board) const {
+    return this->_isClassic == (dynamic_cast<const ClassicBoard*>(&board) != nullptr)
+        && this->_gridSize == board.gridSize()
+        && this->_totalPlayers == static_cast<int>(board.players().size());
+}
+
+bool OpeningBook::find(Board const& board, int playerNumber, int& cellNumber) const {
+    int symmetry = 0;
+    const std::unordered_map<uint64_t, uint16_t>::const_iterator it = 
+        this->_cells.find(OpeningBook::_key(board, playerNumber, symmetry));
+
+    if (it == this->_cells.end()) return false;
+
+    //A book built from other games may collide with a position it hasn't seen.
+    const int bookCell = board.cellNumberBySymmetry(it->second, symmetry);
+    if (!board.isCellAvailable(bookCell)) return false;
+
+    cellNumber = bookCell;
+    return true;
+}
+
+size_t OpeningBook::size() const { return this->_cells.size(); }
+
+uint64_t OpeningBook::_key(Board const& board, int playerNumber, int& symmetry) {
+    return board.canonicalHash(symmetry) ^ Board::zobristKey(-1, playerNumber);
+}
+
+int OpeningBook::_solve(Board& board, int playerNumber, std::unordered_map<uint64_t, int>& values) {
+    int symmetry = 0;
+    const uint64_t key = OpeningBook::_key(board, playerNumber, symmetry);
+    const std::unordered_map<uint64_t, int>::const_iterator it = values.find(key);
+
+    if (it != values.end()) return it->second;
+
+    //Listed up front, since the available cells are reordered by marking them. 
+    //Sorted to always pick the same cell among equally good ones.
+    std::vector<int> cells {};
+    board.readAvailableCellNumbers(cells);
+    std::sort(cells.begin(), cells.end());
+
+    int bestValue = std::numeric_limits<int>::min();
+    int bestCell = -1;
+
+    for (int cell : cells) {
+        const int points = board.applyMove(cell, playerNumber);
+        int value = 0;
+
+        //Winning with more cells left is better, the same way losing later is.
+        if (points > 0) value = 1 + board.totalAvailableCells();
+        else if (!board.isCompleted()) value = -this->_solve(board, playerNumber % 2 + 1, values);
+
+        board.undoMove();
+
+        if (value > bestValue) {
+            bestValue = value;
+            bestCell = cell;
+        }
+    }
+
+    values[key] = bestValue;
+    this->_cells[key] = board.symmetricCellNumber(bestCell, symmetry);
+    return bestValue;
+}
+
+std::shared_ptr<const Evaluator> Evaluator::create(std::string const& name) {
+    if (name == "chain") return std::make_shared<const ChainEvaluator>();
+    if (name == "pattern") return std::make_shared<const PatternEvaluator>();
+
+    throw std::runtime_error("Unknown evaluator '" + name + "', expected 'chain' or 'pattern'.");
+}
+
+int Evaluator::evaluateLeaf(Board const& board, int playerNumber) const {
+    const ChainMap& chainMap = board.chainMap(playerNumber);
+    int bestTotalConnected = 0;
+
+    for (int i = 0; i < board.totalAvailableCells(); i++) {
+        bestTotalConnected = std::max(
+            bestTotalConnected, 
+            board.connectedCellByChainMap(chainMap, board.availableCellNumber(i)).totalConnected);
+    }
+
+    return bestTotalConnected * Evaluator::POINT_VALUE / 2;
+}
+
+bool Evaluator::isReadingWindows() const { return false; }
+
+void Evaluator::_sortRankedCells(std::vector<ConnectedCell>& rankedCells) {
+    std::sort(rankedCells.begin(), rankedCells.end(), [](const ConnectedCell& a, const ConnectedCell& b) {
+        return a.totalConnected > b.totalConnected
+            //When total connected cells are equals, rank based on their score instead.
+            || (a.totalConnected == b.totalConnected && a.score > b.score);
+    });
+}
+
+std::string ChainEvaluator::name() const { return "chain"; }
+
+void ChainEvaluator::rankCells(
+    Board const& board, 
+    int playerNumber, 
+    std::vector<int> const& cellNumbers, 
+    std::vector<ConnectedCell>& rankedCells) const {
+    const ChainMap& chainMap = board.chainMap(playerNumber);
+    rankedCells.clear();
+
+    for (int cellNumber : cellNumbers) {
+        ConnectedCell cell = board.connectedCellByChainMap(chainMap, cellNumber);
+        cell.score = cell.verticalChain + cell.horizontalChain + cell.diagonalLeftChain + cell.diagonalRightChain;
+        rankedCells.push_back(cell);
+    }
+
+    Evaluator::_sortRankedCells(rankedCells);
+}
+
+std::string PatternEvaluator::name() const { return "pattern"; }
+
+void PatternEvaluator::rankCells(
+    Board const& board, 
+    int playerNumber, 
+    std::vector<int> const& cellNumbers, 
+    std::vector<ConnectedCell>& rankedCells) const {
+    PatternEvaluator::_requireWindows(board);
+
+    const ChainMap& chainMap = board.chainMap(playerNumber);
+    rankedCells.clear();
+
+    for (int cellNumber : cellNumbers) {
+        ConnectedCell cell = board.connectedCellByChainMap(chainMap, cellNumber);
+        cell.score = PatternEvaluator::_cellScore(board, playerNumber, cellNumber, cell.row, cell.column);
+        rankedCells.push_back(cell);
+    }
+
+    Evaluator::_sortRankedCells(rankedCells);
+}
+
+int PatternEvaluator::evaluateLeaf(Board const& board, int playerNumber) const {
+    PatternEvaluator::_requireWindows(board);
+
+    const ChainMap& chainMap = board.chainMap(playerNumber);
+    int bestTotalConnected = 0;
+    int bestScore = 0;
+
+    for (int i = 0; i < board.totalAvailableCells(); i++) {
+        const int cellNumber = board.availableCellNumber(i);
+        const ConnectedCell cell = board.connectedCellByChainMap(chainMap, cellNumber);
+        if (cell.totalConnected < bestTotalConnected) continue;
+
+        const int score = PatternEvaluator::_cellScore(board, playerNumber, cellNumber, cell.row, cell.column);
+
+        if (cell.totalConnected > bestTotalConnected || score > bestScore) {
+            bestTotalConnected = cell.totalConnected;
+            bestScore = score;
+        }
+    }
+
+    return bestTotalConnected * Evaluator::POINT_VALUE / 2 + std::min(bestScore, Evaluator::POINT_VALUE / 2 - 1);
+}
+
+bool PatternEvaluator::isReadingWindows() const { return true; }
+
+std::array<uint8_t, 1 << (2 * PatternEvaluator::WINDOW_RADIUS)> const& PatternEvaluator::_sideShapes() {
+    static const std::array<uint8_t, 1 << (2 * WINDOW_RADIUS)> shapes = []() {
+        std::array<uint8_t, 1 << (2 * WINDOW_RADIUS)> shapes {};
+
+        for (size_t code = 0; code < shapes.size(); code++) {
+            const size_t blockedCells = code & ((1 << WINDOW_RADIUS) - 1);
+            const size_t ownCells = code >> WINDOW_RADIUS;
+            int run = 0;
+            int span = 0;
+
+            //Own cells are always blocked as well, any other code can't be made.
+            if ((ownCells & ~blockedCells) != 0) continue;
+
+            //Own cells running from the nearest one, then cells until the first one blocked by others.
+            while (run < WINDOW_RADIUS && (ownCells >> run & 1) != 0) run++;
+            while (span < WINDOW_RADIUS && ((blockedCells & ~ownCells) >> span & 1) == 0) span++;
+
+            shapes[code] = static_cast<uint8_t>(run * (WINDOW_RADIUS + 1) + span);
+        }
+
+        return shapes;
+    }();
+
+    return shapes;
+}
+
+std::array<uint16_t, PatternEvaluator::TOTAL_SIDE_SHAPES * PatternEvaluator::TOTAL_SIDE_SHAPES> const& 
+    PatternEvaluator::_lineValues() {
+    static const std::array<uint16_t, TOTAL_SIDE_SHAPES * TOTAL_SIDE_SHAPES> values = []() {
+        std::array<uint16_t, TOTAL_SIDE_SHAPES * TOTAL_SIDE_SHAPES> values {};
+
+        for (int shape = 0; shape < TOTAL_SIDE_SHAPES; shape++) {
+            for (int oppositeShape = 0; oppositeShape < TOTAL_SIDE_SHAPES; oppositeShape++) {
+                const int run = shape / (WINDOW_RADIUS + 1);
+                const int span = shape % (WINDOW_RADIUS + 1);
+                const int oppositeRun = oppositeShape / (WINDOW_RADIUS + 1);
+                const int oppositeSpan = oppositeShape % (WINDOW_RADIUS + 1);
+
+                //Shapes where the span is shorter than the run can't be encoded.
+                if (span < run || oppositeSpan < oppositeRun) continue;
+
+                //Including the marked cell itself.
+                const int totalRun = 1 + run + oppositeRun;
+                const int totalSpan = 1 + span + oppositeSpan;
+                //An end is open when there's an empty cell right after the run.
+                const int totalOpenEnds = (span > run) + (oppositeSpan > oppositeRun);
+                int value = 0;
+
+                //Nothing can be chained along a line that's too short, no matter how it's marked.
+                if (totalSpan < 3) {
+                    value = 0;
+                } else if (totalRun >= 3) {
+                    //Already counted by its points, but each open end extends it by another one.
+                    value = 8 * totalRun * totalOpenEnds;
+                } else if (totalRun == 2) {
+                    value = totalOpenEnds == 2 ? 24 : 10 * totalOpenEnds;
+                } else {
+                    value = totalSpan - 2;
+                }
+
+                const bool isThreat = totalRun >= 2 && totalOpenEnds > 0;
+                values[shape * TOTAL_SIDE_SHAPES + oppositeShape] = static_cast<uint16_t>(value << 1 | isThreat);
+            }
+        }
+
+        return values;
+    }();
+
+    return values;
+}
+
+int PatternEvaluator::_cellScore(Board const& board, int playerNumber, int cellNumber, int row, int column) {
+    static const std::array<uint8_t, 1 << (2 * WINDOW_RADIUS)>& sideShapes = PatternEvaluator::_sideShapes();
+    static const std::array<uint16_t, TOTAL_SIDE_SHAPES * TOTAL_SIDE_SHAPES>& lineValues = 
+        PatternEvaluator::_lineValues();
+    static_assert(PatternEvaluator::WINDOW_RADIUS == Board::WINDOW_RADIUS, "Windows are read as they're kept.");
+    const int lastIndex = board.gridSize() - 1;
+    //Cells left toward each edge within the window, the rest of it is outside the grid.
+    const int down = std::min(lastIndex - row, WINDOW_RADIUS);
+    const int up = std::min(row, WINDOW_RADIUS);
+    const int right = std::min(lastIndex - column, WINDOW_RADIUS);
+    const int left = std::min(column, WINDOW_RADIUS);
+    //In the order of directions within a window.
+    const int insideCells[8] = { 
+        down, up, right, left, std::min(down, right), std::min(up, left), std::min(down, left), std::min(up, right) 
+    };
+    const uint32_t markedWindow = board.markedWindow(cellNumber);
+    const uint32_t playerWindow = board.playerWindow(playerNumber, cellNumber);
+    const uint32_t sideMask = (1 << WINDOW_RADIUS) - 1;
+    int score = 0;
+    int totalThreats = 0;
+
+    for (int direction = 0; direction < 8; direction += 2) {
+        int shapes[2] {};
+
+        for (int side = 0; side < 2; side++) {
+            const int shift = WINDOW_RADIUS * (direction + side);
+            const uint32_t blockedCells = (markedWindow >> shift & sideMask) 
+                | (sideMask << insideCells[direction + side] & sideMask);
+            const uint32_t ownCells = playerWindow >> shift & sideMask;
+
+            shapes[side] = sideShapes[blockedCells | ownCells << WINDOW_RADIUS];
+        }
+
+        const uint16_t lineValue = lineValues[shapes[0] * TOTAL_SIDE_SHAPES + shapes[1]];
+        score += lineValue >> 1;
+        totalThreats += lineValue & 1;
+    }
+
+    if (totalThreats > 1) score += PatternEvaluator::DOUBLE_THREAT_VALUE;
+
+    return score;
+}
+
+void PatternEvaluator::_requireWindows(Board const& board) {
+    if (!board.isKeepingWindows()) throw std::runtime_error("Pattern evaluator needs a board keeping its windows.");
+}
+
+Bot::Bot(int number, std::string marker, SearchOptions searchOptions) : 
+    Player(number, marker),
+    _searchOptions(searchOptions),
+    _evaluator(searchOptions.evaluator != nullptr ? searchOptions.evaluator : std::make_shared<const ChainEvaluator>()) {
+}
+
+std::string Bot::name() { return "Bot"; }
+
+std::shared_ptr<const Evaluator> const& Bot::evaluator() const { return this->_evaluator; }
+
+int Bot::requireCellSelection(Board const& board) {
+    INSTRUMENT(const Instrumentation::MoveScope moveScope {};)
+    const std::shared_ptr<const OpeningBook>& openingBook = this->_searchOptions.openingBook;
+    int bookCell = -1;
+
+    //Known positions are answered straight away.
+    if (openingBook != nullptr && openingBook->fits(board) && openingBook->find(board, this->_number, bookCell)) {
+        return bookCell;
+    }
+
+    //Cheaply ruled out first, so the book isn't solved for boards it never fits.
+    if (this->_searchOptions.isSolvedBookUsed 
+        && board.players().size() == 2
+        && board.gridSize() == 3
+        && OpeningBook::solvedClassic()->fits(board) 
+        && OpeningBook::solvedClassic()->find(board, this->_number, bookCell)) {
+        return bookCell;
+    }
+
+    const int heuristicCell = this->_findHeuristicCell(board);
+
+    //Nothing to look ahead when there's only one choice left.
+    if (board.totalAvailableCells() <= 1) return heuristicCell;
+
+    if (this->_searchOptions.monteCarloPlayouts > 0) return this->_searchMonteCarlo(board, heuristicCell);
+
+    if (this->_searchOptions.maxDepth <= 1) return heuristicCell;
+
+    return this->_searchBestCell(board, heuristicCell);
+}
+
+int Bot::_findHeuristicCell(Board const& board) {
+    if (this->_searchScratches.empty()) this->_prepareSearchScratches(board, 1);
+
+    SearchScratch& scratch = this->_searchScratches.at(0);
+    const int totalPlayers = board.players().size();
+    std::vector<int>& availableCells = scratch.availableCells;
+    std::vector<ConnectedCell>& rankedCells = scratch.rankedCells;
+    std::vector<ConnectedCell>& playerToBlockCells = scratch.playerToBlockCells;
+    const Player* playerToBlock = nullptr;
+
+    board.readAvailableCellNumbers(availableCells);
+    this->_rankAvailableCells(board, *this, availableCells, rankedCells);
+    playerToBlockCells.clear();
+    
+    //Searching player to block.
+    //Iterate from the next player turn — right side in the array — from this bot, 
+    //up until latest player turn — left side in the array —, whilist ignoring this bot index.
+    //This bot index same as this bot number - 1.
+    for (int n = this->_number % totalPlayers, i = n;
+        n < totalPlayers + this->_number % totalPlayers && i != this->_number - 1;
+        n++, i = n % totalPlayers) {
+        const Player& player = *board.players().at(i);
+        std::vector<ConnectedCell>& playerCells = scratch.playerCells;
+
+        this->_rankAvailableCells(board, player, availableCells, playerCells);
+
+        const Player& playerShortestNextTurn = playerToBlock == nullptr
+            ? player
+            : this->_compareNextTurn(*playerToBlock, player);
+            
+        if (playerToBlockCells.empty()
+            //Replace targeted player when the new one have more cell to connect.
+            || playerCells.at(0).totalConnected > playerToBlockCells.at(0).totalConnected
+            //Prioritize to block player with shortest turn distance from this bot.
+            || (playerCells.at(0).totalConnected == playerToBlockCells.at(0).totalConnected
+                && &playerShortestNextTurn == &player)) {
+            //Swapped instead of copied, the other buffer is overwritten by the next player anyway.
+            std::swap(playerToBlockCells, playerCells);
+            playerToBlock = &player;
+        }
+    }
+    
+    //Points into the ranked cells, which are left untouched from here on.
+    const ConnectedCell* bestCell = rankedCells.at(0).totalConnected >= 3 ? &rankedCells.at(0) : nullptr;
+     
+    //Looking whether it's necessary to block.
+    for (const ConnectedCell& playerCell : playerToBlockCells) {
+        //No need to block when they have nothing to connect.
+        if (playerCell.totalConnected == 0) break;
+        
+        //Immediately block when the amount of connected cell is bigger than this bot.
+        if (playerCell.totalConnected > rankedCells.at(0).totalConnected) {
+            bestCell = &playerCell;
+            break;
+        } 
+        
+        bool isBestCellFound = false;
+        
+        //When the targeted player has an equal maximum amount of cell to connect.
+        //Try to find a cell that's not only can block them but also create a new chain.
+        //If can't be found, just block any cell with the same total connected cell.
+        //
+        //Assume this bot ranked cells : { 11, 12, 13, ... }
+        //Targeted player ranked cells : { 16, 17, 18, 13, ... }
+        //If they all have the same total connected cell. That's means 13 is the best cell,
+        //not only for this bot to make a chain, but also effectively block them.
+        for (const ConnectedCell& rankedCell : rankedCells) {
+            if (playerCell.totalConnected == rankedCells.at(0).totalConnected 
+                && playerCell.totalConnected == rankedCell.totalConnected) {
+                bestCell = &playerCell;
+                const bool isSamePosition = playerCell.row == rankedCell.row 
+                    && playerCell.column == rankedCell.column;
+
+                //Keep iterating until we find it.
+                if (isSamePosition) isBestCellFound = true;
+                else continue;
+            }
+            
+            break;
+        }
+        
+        if (isBestCellFound) break;
+    }
+    
+    //Found the best cell.
+    if (bestCell != nullptr) {
+        return board.cellNumberByPosition(bestCell->row, bestCell->column);
+
+    //There's atleast a cell to chain.
+    } else if (rankedCells.at(0).verticalChain >= 1
+        || rankedCells.at(0).horizontalChain >= 1
+        || rankedCells.at(0).diagonalLeftChain >= 1
+        || rankedCells.at(0).diagonalRightChain >= 1) {
+        return board.cellNumberByPosition(rankedCells.at(0).row, rankedCells.at(0).column);
+    }
+
+    //Pick randomly when there's nothing to chain.
+    return availableCells.at(board.random().below(availableCells.size()));
+}
+
+int Bot::_searchBestCell(Board const& board, int heuristicCell) {
+    const int totalThreads = std::max(1, this->_searchOptions.totalThreads);
+    this->_prepareSearchBoards(board, totalThreads);
+
+    //Heuristic cell goes first, so it's picked whenever every other cell is just as good.
+    std::vector<int>& rootCells = this->_searchScratches.at(0).rootCells;
+    rootCells.assign(1, heuristicCell);
+
+    this->_findCandidateCells(board, this->_number, rootCells, this->_searchScratches.at(0));
+
+    if (this->_transpositionTable == nullptr) {
+        this->_transpositionTable = std::make_unique<TranspositionTable>(
+            this->_searchOptions.transpositionTableMegabytes);
+    }
+
+    this->_transpositionTable->age();
+    this->_searchDeadline = this->_searchOptions.seed.has_value()
+        ? std::chrono::steady_clock::time_point::max()
+        : std::chrono::steady_clock::now() + this->_searchOptions.timeBudget;
+    this->_isSearchTimeout = false;
+
+    if (totalThreads == 1) {
+        SearchContext context { *this->_searchBoards.at(0), 0, this->_searchScratches.at(0) };
+        return this->_searchIteratively(context, rootCells);
+    }
+
+    if (this->_threadPool == nullptr) {
+        this->_threadPool = std::make_unique<ThreadPool>(this->_searchOptions.totalThreads);
+    }
+
+    return this->_searchOptions.isLazySmp
+        ? this->_searchLazySmp(rootCells)
+        : this->_searchRootInParallel(rootCells);
+}
+
+int Bot::_searchIteratively(SearchContext& context, std::vector<int>& rootCells) {
+    int bestCell = rootCells.at(0);
+
+    for (int depth = 1; depth <= this->_searchOptions.maxDepth; depth++) {
+        int alpha = -std::numeric_limits<int>::max() / 2;
+        int depthBestCell = -1;
+
+        for (int cell : rootCells) {
+            const int value = this->_searchMove(
+                context, 
+                cell, 
+                this->_number, 
+                depth, 
+                alpha, 
+                std::numeric_limits<int>::max() / 2);
+
+            if (this->_isSearchTimeout) break;
+
+            if (depthBestCell == -1 || value > alpha) {
+                alpha = value;
+                depthBestCell = cell;
+            }
+        }
+
+        //Discard unfinished search, its result isn't comparable with the previous one.
+        if (this->_isSearchTimeout) break;
+
+        //Search the best cell first on the next depth, it's most likely still the best one.
+        const std::vector<int>::iterator it = std::find(rootCells.begin(), rootCells.end(), depthBestCell);
+        std::rotate(rootCells.begin(), it, it + 1);
+        bestCell = depthBestCell;
+    }
+
+    return bestCell;
+}
+
+int Bot::_searchRootInParallel(std::vector<int>& rootCells) {
+    std::vector<int>& values = this->_searchScratches.at(0).rootValues;
+    int bestCell = rootCells.at(0);
+    int depth = 1;
+    //Only captures two pointers, small enough for the task to be stored without allocating.
+    const std::function<void(int, int)> searchRootCell = [this, &depth](int taskIndex, int threadIndex) {
+        SearchContext context { *this->_searchBoards.at(threadIndex), 0, this->_searchScratches.at(threadIndex) };
+        this->_searchScratches.at(0).rootValues.at(taskIndex) = this->_searchMove(
+            context,
+            this->_searchScratches.at(0).rootCells.at(taskIndex),
+            this->_number,
+            depth,
+            -std::numeric_limits<int>::max() / 2,
+            std::numeric_limits<int>::max() / 2);
+    };
+
+    values.assign(rootCells.size(), 0);
+
+    for (; depth <= this->_searchOptions.maxDepth; depth++) {
+        this->_threadPool->run(rootCells.size(), searchRootCell);
+
+        if (this->_isSearchTimeout) break;
+
+        //Ties go to the cell coming first, same as when searching on a single thread.
+        const int bestIndex = std::max_element(values.begin(), values.end()) - values.begin();
+
+        std::rotate(rootCells.begin(), rootCells.begin() + bestIndex, rootCells.begin() + bestIndex + 1);
+        bestCell = rootCells.at(0);
+    }
+
+    return bestCell;
+}
+
+int Bot::_searchLazySmp(std::vector<int> const& rootCells) {
+    struct LazySmpSearch {
+        std::vector<int> const& rootCells;
+        const uint64_t seed;
+        int bestCell;
+    };
+
+    //Orders of the helper threads only have to differ from each other, so they're taken from the position.
+    LazySmpSearch search { rootCells, this->_searchBoards.at(0)->hash(), rootCells.at(0) };
+    //Only captures two pointers, small enough for the task to be stored without allocating.
+    const std::function<void(int, int)> searchFromThread = [this, &search](int taskIndex, int threadIndex) {
+        SearchContext context { *this->_searchBoards.at(threadIndex), 0, this->_searchScratches.at(threadIndex) };
+        //Copied into own scratch, since root cells of the first thread are used as the source.
+        std::vector<int>& cells = this->_searchScratches.at(threadIndex).candidateCellsByDepth.at(0);
+
+        cells.assign(search.rootCells.begin(), search.rootCells.end());
+
+        if (taskIndex == 0) {
+            search.bestCell = this->_searchIteratively(context, cells);
+            this->_isSearchTimeout = true;
+            return;
+        }
+
+        RandomEngine engine(search.seed + taskIndex);
+        std::shuffle(cells.begin(), cells.end(), engine);
+        this->_searchIteratively(context, cells);
+    };
+
+    this->_threadPool->run(this->_threadPool->totalThreads(), searchFromThread);
+    return search.bestCell;
+}
+
+int Bot::_searchMonteCarlo(Board const& board, int heuristicCell) {
+    struct MonteCarloSearch {
+        const uint64_t seed;
+        std::atomic<long> totalPlayouts;
+    };
+
+    const int totalThreads = std::max(1, this->_searchOptions.totalThreads);
+    this->_prepareSearchBoards(board, totalThreads);
+
+    if (this->_monteCarloTree == nullptr) {
+        this->_monteCarloTree = std::make_unique<MonteCarloTree>(this->_searchOptions.monteCarloTreeMegabytes);
+    }
+
+    this->_reuseMonteCarloTree(board);
+
+    MonteCarloTree& tree = *this->_monteCarloTree;
+    MonteCarloTree::Node& root = tree.node(MonteCarloTree::ROOT);
+
+    //Expanded straight away with the heuristic cell going first, so it's picked whenever nothing is visited more.
+    if (root.state.load(std::memory_order_relaxed) == MonteCarloTree::State::LEAF) {
+        std::vector<int>& rootCells = this->_searchScratches.at(0).rootCells;
+        rootCells.assign(1, heuristicCell);
+
+        this->_findCandidateCells(board, this->_number, rootCells, this->_searchScratches.at(0));
+        if (!this->_expandMonteCarloNode(root, rootCells, this->_number)) return heuristicCell;
+    }
+
+    this->_searchDeadline = this->_searchOptions.seed.has_value()
+        ? std::chrono::steady_clock::time_point::max()
+        : std::chrono::steady_clock::now() + this->_searchOptions.timeBudget;
+    this->_isSearchTimeout = false;
+
+    //Rollouts of each thread only have to differ from each other, so they're seeded from the position.
+    MonteCarloSearch search { board.hash(), { 0 } };
+    //Only captures two pointers, small enough for the task to be stored without allocating.
+    const std::function<void(int, int)> playOutFromThread = [this, &search](int taskIndex, int threadIndex) {
+        SearchContext context { *this->_searchBoards.at(threadIndex), 0, this->_searchScratches.at(threadIndex) };
+        RandomEngine random(search.seed + taskIndex);
+
+        while (!this->_isSearchTimeout 
+            && search.totalPlayouts.fetch_add(1, std::memory_order_relaxed) < this->_searchOptions.monteCarloPlayouts) {
+            this->_playOutMonteCarlo(context, random);
+
+            //Checking the clock is relatively expensive, so only do it once in a while.
+            if (++context.searchedNodes % 16 == 0 && std::chrono::steady_clock::now() >= this->_searchDeadline) {
+                this->_isSearchTimeout = true;
+            }
+        }
+    };
+
+    if (totalThreads == 1) {
+        playOutFromThread(0, 0);
+    } else {
+        if (this->_threadPool == nullptr) this->_threadPool = std::make_unique<ThreadPool>(totalThreads);
+
+        this->_threadPool->run(totalThreads, playOutFromThread);
+    }
+
+    int32_t bestChild = root.firstChild;
+
+    for (int32_t child = root.firstChild; child < root.firstChild + root.totalChildren; child++) {
+        if (tree.node(child).visits.load(std::memory_order_relaxed) 
+            > tree.node(bestChild).visits.load(std::memory_order_relaxed)) {
+            bestChild = child;
+        }
+    }
+
+    return tree.node(bestChild).cellNumber;
+}
+
+void Bot::_reuseMonteCarloTree(Board const& board) {
+    MonteCarloTree& tree = *this->_monteCarloTree;
+    std::vector<std::pair<int, int>>& rootMoves = this->_monteCarloRootMoves;
+    const int totalPlayers = board.players().size();
+    const size_t totalMoves = board.totalMarkedCells();
+    bool isReused = tree.size() > 0 && rootMoves.size() <= totalMoves;
+    int32_t index = MonteCarloTree::ROOT;
+
+    //The previous root has to be the same position, as it may be from the previous game.
+    for (size_t i = 0; isReused && i < rootMoves.size(); i++) {
+        const int cellNumber = board.markedCellNumber(i);
+        isReused = rootMoves.at(i) == std::make_pair(cellNumber, board.cellPlayerNumber(cellNumber));
+    }
+
+    //Follow every move made since then, as long as they've been expanded.
+    for (size_t i = rootMoves.size(); isReused && i < totalMoves; i++) {
+        const MonteCarloTree::Node& node = tree.node(index);
+        const int cellNumber = board.markedCellNumber(i);
+        isReused = false;
+
+        if (node.state.load(std::memory_order_relaxed) != MonteCarloTree::State::EXPANDED) break;
+
+        for (int32_t child = node.firstChild; child < node.firstChild + node.totalChildren; child++) {
+            if (tree.node(child).cellNumber == cellNumber 
+                && tree.node(child).playerNumber == board.cellPlayerNumber(cellNumber)) {
+                index = child;
+                isReused = true;
+                break;
+            }
+        }
+    }
+
+    rootMoves.clear();
+
+    for (size_t i = 0; i < totalMoves; i++) {
+        const int cellNumber = board.markedCellNumber(i);
+        rootMoves.emplace_back(cellNumber, board.cellPlayerNumber(cellNumber));
+    }
+
+    //Root is reached by the player right before this bot, so this bot marks its children.
+    if (isReused) tree.reroot(index);
+    else tree.clear(totalMoves == 0 ? -1 : board.markedCellNumber(totalMoves - 1), 
+        (this->_number + totalPlayers - 2) % totalPlayers + 1);
+}
+
+void Bot::_playOutMonteCarlo(SearchContext& context, RandomEngine& random) {
+    Board& board = context.board;
+    SearchScratch& scratch = context.scratch;
+    MonteCarloTree& tree = *this->_monteCarloTree;
+    std::vector<int32_t>& path = scratch.monteCarloPath;
+    const int totalPlayers = board.players().size();
+    int32_t index = MonteCarloTree::ROOT;
+
+    INSTRUMENT(Instrumentation::threadCounters().searchedNodes++;)
+    path.assign(1, index);
+    tree.node(index).visits.fetch_add(1, std::memory_order_relaxed);
+
+    while (!board.isCompleted()) {
+        MonteCarloTree::Node& node = tree.node(index);
+        uint8_t state = node.state.load(std::memory_order_acquire);
+
+        //Only a single thread expands a leaf, the others play out from it in the meantime.
+        //Leaves of a full tree are played out without looking for candidates they have no room for.
+        if (state == MonteCarloTree::State::LEAF) {
+            if (node.visits.load(std::memory_order_relaxed) < Bot::EXPANSION_VISITS
+                || tree.isFull()
+                || !node.state.compare_exchange_strong(state, MonteCarloTree::State::EXPANDING)) {
+                break;
+            }
+
+            const int playerNumber = node.playerNumber % totalPlayers + 1;
+            std::vector<int>& cells = scratch.candidateCellsByDepth.at(0);
+            cells.clear();
+
+            this->_findCandidateCells(board, playerNumber, cells, scratch);
+            if (!this->_expandMonteCarloNode(node, cells, playerNumber)) break;
+
+        } else if (state != MonteCarloTree::State::EXPANDED) {
+            break;
+        }
+
+        index = this->_selectMonteCarloChild(node);
+        MonteCarloTree::Node& child = tree.node(index);
+
+        child.visits.fetch_add(1, std::memory_order_relaxed);
+        board.applyMove(child.cellNumber, child.playerNumber);
+        path.push_back(index);
+    }
+
+    int playerNumber = tree.node(index).playerNumber;
+    int totalRolloutMoves = 0;
+
+    //Roll out by marking the best ranked cell from a few random ones.
+    while (!board.isCompleted() && totalRolloutMoves < Bot::ROLLOUT_ROUNDS * totalPlayers) {
+        std::vector<int>& cells = scratch.rolloutCells;
+        playerNumber = playerNumber % totalPlayers + 1;
+        cells.clear();
+
+        for (int i = 0; i < Bot::ROLLOUT_SAMPLES; i++) {
+            cells.push_back(board.availableCellNumber(random.below(board.totalAvailableCells())));
+        }
+
+        this->_rankAvailableCells(board, *board.players().at(playerNumber - 1), cells, scratch.rankedCells);
+        board.applyMove(
+            board.cellNumberByPosition(scratch.rankedCells.at(0).row, scratch.rankedCells.at(0).column), 
+            playerNumber);
+        totalRolloutMoves++;
+    }
+
+    int bestScore = std::numeric_limits<int>::min();
+    int worstScore = std::numeric_limits<int>::max();
+
+    for (int number = 1; number <= totalPlayers; number++) {
+        bestScore = std::max(bestScore, board.score(number));
+        worstScore = std::min(worstScore, board.score(number));
+    }
+
+    //Scores are scaled between the worst and the best one, so a bigger lead is rewarded more.
+    for (int32_t node : path) {
+        const int score = board.score(tree.node(node).playerNumber);
+        const int64_t reward = bestScore == worstScore
+            ? MonteCarloTree::REWARD_SCALE / totalPlayers
+            : MonteCarloTree::REWARD_SCALE * (score - worstScore) / (bestScore - worstScore);
+
+        tree.node(node).totalReward.fetch_add(reward, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < totalRolloutMoves + path.size() - 1; i++) board.undoMove();
+}
+
+int32_t Bot::_selectMonteCarloChild(MonteCarloTree::Node const& node) const {
+    MonteCarloTree& tree = *this->_monteCarloTree;
+    const double logVisits = std::log(std::max(1, node.visits.load(std::memory_order_relaxed)));
+    int32_t bestChild = node.firstChild;
+    double bestValue = -std::numeric_limits<double>::max();
+
+    for (int32_t child = node.firstChild; child < node.firstChild + node.totalChildren; child++) {
+        const int32_t visits = tree.node(child).visits.load(std::memory_order_relaxed);
+        if (visits == 0) return child;
+
+        const double value = tree.node(child).totalReward.load(std::memory_order_relaxed) 
+            / static_cast<double>(visits * MonteCarloTree::REWARD_SCALE)
+            + Bot::EXPLORATION * std::sqrt(logVisits / visits);
+
+        if (value > bestValue) {
+            bestValue = value;
+            bestChild = child;
+        }
+    }
+
+    return bestChild;
+}
+
+bool Bot::_expandMonteCarloNode(MonteCarloTree::Node& node, std::vector<int> const& cellNumbers, int playerNumber) {
+    MonteCarloTree& tree = *this->_monteCarloTree;
+    const int32_t firstChild = cellNumbers.empty() ? -1 : tree.allocate(cellNumbers.size());
+
+    //Left as a leaf once the pool is full, so the tree stops growing while playouts go on.
+    if (firstChild < 0) {
+        node.state.store(MonteCarloTree::State::LEAF, std::memory_order_release);
+        return false;
+    }
+
+    for (size_t i = 0; i < cellNumbers.size(); i++) {
+        MonteCarloTree::Node& child = tree.node(firstChild + i);
+
+        child.firstChild = -1;
+        child.totalChildren = 0;
+        child.cellNumber = cellNumbers.at(i);
+        child.playerNumber = static_cast<uint8_t>(playerNumber);
+        child.state.store(MonteCarloTree::State::LEAF, std::memory_order_relaxed);
+        child.visits.store(0, std::memory_order_relaxed);
+        child.totalReward.store(0, std::memory_order_relaxed);
+    }
+
+    node.firstChild = firstChild;
+    node.totalChildren = cellNumbers.size();
+    node.state.store(MonteCarloTree::State::EXPANDED, std::memory_order_release);
+    return true;
+}
+
+int Bot::_searchMove(SearchContext& context, int cellNumber, int playerNumber, int depth, int alpha, int beta) {
+    Board& board = context.board;
+    const int totalPlayers = board.players().size();
+    const int points = board.applyMove(cellNumber, playerNumber);
+    const bool isCompleted = board.isCompleted();
+    int value = (playerNumber == this->_number ? points : -points) * Evaluator::POINT_VALUE;
+
+    //The window is shifted by this move value, as the following moves only add up to it.
+    if (!isCompleted) {
+        value += this->_searchMinimax(
+            context, 
+            playerNumber % totalPlayers + 1, 
+            depth - 1, 
+            alpha - value, 
+            beta - value);
+    }
+
+    board.undoMove();
+    return value;
+}
+
+int Bot::_searchMinimax(SearchContext& context, int playerNumber, int depth, int alpha, int beta) {
+    Board& board = context.board;
+
+    INSTRUMENT(Instrumentation::threadCounters().searchedNodes++;)
+
+    //Checking the clock is relatively expensive, so only do it once in a while.
+    if (++context.searchedNodes % 1024 == 0 && std::chrono::steady_clock::now() >= this->_searchDeadline) {
+        this->_isSearchTimeout = true;
+    }
+
+    if (this->_isSearchTimeout) return 0;
+
+    //Values don't include points gained before reaching this position,
+    //so they can be reused no matter the order of moves leading here.
+    int symmetry = 0;
+    const uint64_t key = board.canonicalHash(symmetry) ^ Board::zobristKey(-1, playerNumber);
+    TranspositionTable::Entry entry {};
+    int hashedCell = -1;
+
+    if (this->_transpositionTable->probe(key, entry)) {
+        const TranspositionTable::Bound bound = static_cast<TranspositionTable::Bound>(entry.boundAndAge & 3);
+
+        //Only reuse value searched at the same depth, even though the deeper one is more accurate.
+        //This way, the result doesn't depend on what the table contains, which is required
+        //to be reproducible when searching with multiple threads.
+        if (entry.depth == depth 
+            && (bound == TranspositionTable::Bound::EXACT
+                || (bound == TranspositionTable::Bound::LOWER && entry.value >= beta)
+                || (bound == TranspositionTable::Bound::UPPER && entry.value <= alpha))) {
+            return entry.value;
+        }
+
+        if (entry.cellNumber != TranspositionTable::NO_CELL) {
+            hashedCell = board.cellNumberBySymmetry(entry.cellNumber, symmetry);
+        }
+    }
+
+    if (depth <= 0) {
+        const int value = this->_evaluateSearchLeaf(board, playerNumber);
+        
+        this->_transpositionTable->store(key, 0, value, TranspositionTable::Bound::EXACT, -1);
+        return value;
+    }
+
+    const bool isMaximizing = playerNumber == this->_number;
+    const int originalAlpha = alpha;
+    const int originalBeta = beta;
+    int bestValue = isMaximizing ? -std::numeric_limits<int>::max() / 2 : std::numeric_limits<int>::max() / 2;
+    int bestCell = -1;
+    std::vector<int>& candidateCells = context.scratch.candidateCellsByDepth.at(depth);
+
+    candidateCells.clear();
+    this->_findCandidateCells(board, playerNumber, candidateCells, context.scratch);
+
+    //Search previous best cell first. It's only reordered instead of added, 
+    //which also covers when the key collides with other position.
+    const std::vector<int>::iterator hashedCellIt = std::find(candidateCells.begin(), candidateCells.end(), hashedCell);
+    if (hashedCellIt != candidateCells.end()) std::rotate(candidateCells.begin(), hashedCellIt, hashedCellIt + 1);
+
+    for (int cell : candidateCells) {
+        const int value = this->_searchMove(context, cell, playerNumber, depth, alpha, beta);
+
+        if (bestCell == -1 || (isMaximizing ? value > bestValue : value < bestValue)) {
+            bestValue = value;
+            bestCell = cell;
+        }
+
+        if (isMaximizing) alpha = std::max(alpha, value);
+        else beta = std::min(beta, value);
+
+        if (alpha >= beta) break;
+    }
+
+    if (!this->_isSearchTimeout) {
+        const TranspositionTable::Bound bound = bestValue <= originalAlpha 
+            ? TranspositionTable::Bound::UPPER 
+            : (bestValue >= originalBeta ? TranspositionTable::Bound::LOWER : TranspositionTable::Bound::EXACT);
+
+        this->_transpositionTable->store(key, depth, bestValue, bound, board.symmetricCellNumber(bestCell, symmetry));
+    }
+
+    return bestValue;
+}
+
+int Bot::_evaluateSearchLeaf(Board const& board, int playerNumber) {
+    const int value = this->_evaluator->evaluateLeaf(board, playerNumber);
+    return playerNumber == this->_number ? value : -value;
+}
+
+void Bot::_findCandidateCells(
+    Board const& board, 
+    int playerNumber, 
+    std::vector<int>& candidateCells, 
+    SearchScratch& scratch) {
+    const int totalPlayers = board.players().size();
+    const size_t limit = candidateCells.size() + this->_searchOptions.candidateLimit;
+    std::vector<ConnectedCell>& rankedCells = scratch.rankedCells;
+    std::vector<ConnectedCell>& playerToBlockCells = scratch.playerToBlockCells;
+
+    board.readAvailableCellNumbers(scratch.availableCells);
+    this->_rankAvailableCells(board, *board.players().at(playerNumber - 1), scratch.availableCells, rankedCells);
+    playerToBlockCells.clear();
+
+    //Find the player with most cells to connect, with ties going to whoever plays first.
+    for (int n = 1; n < totalPlayers; n++) {
+        const Player& player = *board.players().at((playerNumber - 1 + n) % totalPlayers);
+        std::vector<ConnectedCell>& playerCells = scratch.playerCells;
+
+        this->_rankAvailableCells(board, player, scratch.availableCells, playerCells);
+
+        if (playerToBlockCells.empty() 
+            || playerCells.at(0).totalConnected > playerToBlockCells.at(0).totalConnected) {
+            std::swap(playerToBlockCells, playerCells);
+        }
+    }
+
+    //Alternate between cells to chain and cells to block.
+    for (size_t i = 0; i < rankedCells.size() && candidateCells.size() < limit; i++) {
+        const ConnectedCell* cells[] = { &rankedCells.at(i), &playerToBlockCells.at(i) };
+
+        for (const ConnectedCell* cell : cells) {
+            const int cellNumber = board.cellNumberByPosition(cell->row, cell->column);
+
+            if (candidateCells.size() < limit
+                && std::find(candidateCells.begin(), candidateCells.end(), cellNumber) == candidateCells.end()) {
+                candidateCells.push_back(cellNumber);
+            }
+        }
+    }
+}
+
+void Bot::_prepareSearchBoards(Board const& board, int totalThreads) {
+    this->_searchBoards.resize(totalThreads);
+    if (static_cast<int>(this->_searchScratches.size()) < totalThreads) this->_prepareSearchScratches(board, totalThreads);
+
+    for (int i = 0; i < totalThreads; i++) {
+        std::unique_ptr<Board>& searchBoard = this->_searchBoards.at(i);
+        if (searchBoard == nullptr || !searchBoard->copyFrom(board)) searchBoard = board.clone();
+    }
+}
+
+void Bot::_prepareSearchScratches(Board const& board, int totalScratches) {
+    const size_t totalCells = board.gridSize() * board.gridSize();
+    //Heuristic cell comes before the candidates of the root.
+    const size_t totalCandidateCells = std::min<size_t>(totalCells, this->_searchOptions.candidateLimit + 1);
+
+    this->_searchScratches.resize(totalScratches);
+
+    for (SearchScratch& scratch : this->_searchScratches) {
+        //Depths are counted down to zero.
+        scratch.candidateCellsByDepth.resize(std::max(1, this->_searchOptions.maxDepth) + 1);
+
+        for (std::vector<int>& candidateCells : scratch.candidateCellsByDepth) {
+            candidateCells.reserve(totalCandidateCells);
+        }
+
+        scratch.rootCells.reserve(totalCandidateCells);
+        scratch.rootValues.reserve(totalCandidateCells);
+        scratch.rankedCells.reserve(totalCells);
+        scratch.playerCells.reserve(totalCells);
+        scratch.playerToBlockCells.reserve(totalCells);
+        scratch.monteCarloPath.reserve(totalCells + 1);
+        scratch.rolloutCells.reserve(Bot::ROLLOUT_SAMPLES);
+    }
+}
+
+void Bot::_rankAvailableCells(
+    Board const& board,
+    Player const& player, 
+    std::vector<int> const& availableCellNumbers,
+    std::vector<ConnectedCell>& cells) {
+    INSTRUMENT(Instrumentation::threadCounters().evaluatedCells += availableCellNumbers.size();)
+    this->_evaluator->rankCells(board, player.number(), availableCellNumbers, cells);
+}
+
+Player const& Bot::_compareNextTurn(Player const& player1, Player const& player2) {
+    if ((player1.number() < player2.number() && player2.number() < this->_number) //P1 < P2 < Bot.
+        || (player2.number() < this->_number && this->_number < player1.number()) //P2 < Bot < P1.
+        || (this->_number < player1.number() && player1.number() < player2.number()) //Bot < P1 < P2.
+        //It should never happen anyway as every number are unique.
+        //Normally when this bot number equals to second player number, 
+        //the one returned from this method will be second player, but we don't want that.
+        || this->_number == player2.number()) {
+        return player1;
+    }
+
+    return player2;
+}
+
+size_t BoardSnapshot::totalMoves() const { 
+    return this->_segment == nullptr ? 0 : this->_segment->firstMove + this->_segment->moves.size(); 
+}
+
+int BoardSnapshot::playerTurnNumber() const { return this->_playerTurnNumber; }
+
+size_t BoardSnapshot::_totalCommonMoves(Segment const* segment, Segment const* otherSegment) {
+    //Segments only point to the ones before them, so the one starting later can't be the common one.
+    while (segment != otherSegment) {
+        const size_t firstMove = segment == nullptr ? 0 : segment->firstMove;
+        const size_t otherFirstMove = otherSegment == nullptr ? 0 : otherSegment->firstMove;
+
+        if (segment != nullptr && firstMove >= otherFirstMove) segment = segment->parent.get();
+        if (otherSegment != nullptr && otherFirstMove >= firstMove) otherSegment = otherSegment->parent.get();
+    }
+
+    return segment == nullptr ? 0 : segment->firstMove + segment->moves.size();
+}
+
+Board::Board(
+    std::shared_ptr<Screen> const screen, 
+    const std::vector<std::shared_ptr<Player>> players,
+    int gridSize) :
+    _screen(screen),
+    _players(players),
+    _gridSize(gridSize),
+    _grid(this->_gridSize * this->_gridSize),
+    _totalAvailableCells(this->_grid.size()),
+    _availableCellOffsets(this->_grid.size()),
+    _availableCellIndexOffsets(this->_grid.size()),
+    _chainMaps(this->_players.size()),
+    _scores(this->_players.size(), 0),
+    _engine(RandomEngine::entropySeed()) {
+
+    //Nothing is marked yet, so every chain is zero without having to scan the grid.
+    for (ChainMap& chainMap : this->_chainMaps) {
+        chainMap.vertical.assign(this->_grid.size());
+        chainMap.horizontal.assign(this->_grid.size());
+        chainMap.diagonalLeft.assign(this->_grid.size());
+        chainMap.diagonalRight.assign(this->_grid.size());
+    }
+
+    for (const std::shared_ptr<Player>& player : this->_players) {
+        const Bot* bot = dynamic_cast<const Bot*>(player.get());
+        if (bot != nullptr && bot->evaluator()->isReadingWindows()) this->keepWindows();
+    }
+
+    //Marked and changed cells grow with the game, rather than being reserved for the whole grid.
+    this->_highlightedCells.assign(this->_grid.size());
+}
+
+bool Board::copyFrom(Board const& board) {
+    if (typeid(*this) != typeid(board) || this->_players != board._players || this->_gridSize != board._gridSize) {
+        return false;
+    }
+
+    //Assigning into containers of the same size doesn't allocate.
+    this->_grid = board._grid;
+    this->_totalAvailableCells = board._totalAvailableCells;
+    this->_availableCellOffsets = board._availableCellOffsets;
+    this->_availableCellIndexOffsets = board._availableCellIndexOffsets;
+    this->_chainMaps = board._chainMaps;
+    this->_isKeepingWindows = board._isKeepingWindows;
+    this->_markedWindows = board._markedWindows;
+    this->_playerWindows = board._playerWindows;
+    this->_markedCells = board._markedCells;
+    this->_scores = board._scores;
+    this->_totalScoringMoves = board._totalScoringMoves;
+    this->_snapshotSegment = board._snapshotSegment;
+    this->_totalSnapshotMoves = board._totalSnapshotMoves;
+    this->_totalSymmetries = board._totalSymmetries;
+    this->_hashes = board._hashes;
+    this->_playerTurn = board._playerTurn;
+    this->_engine = board._engine;
+    this->_highlightedCells = board._highlightedCells;
+    //Changed cells keep growing on a board that's never printed, so this one is printed as a whole instead.
+    //Which renders the layout again, rather than copying it on every copy that's never printed.
+    this->_gridLayout.clear();
+    this->_changedCells.clear();
+    this->_renderedGridLine = 0;
+    return true;
+}
+
+const std::vector<std::shared_ptr<Player>>& Board::players() const { return this->_players; }
+
+int Board::gridSize() const { return this->_gridSize; }
+
+const std::shared_ptr<Player>& Board::playerTurn() const { return this->_playerTurn; }
+
+int Board::columnByCellNumber(int cellNumber) const { return cellNumber % this->_gridSize; }
+
+int Board::rowByCellNumber(int cellNumber) const { return cellNumber / this->_gridSize; }
+
+int Board::cellNumberByPosition(int row, int column) const { return row * this->_gridSize + column; }
+
+int Board::totalAvailableCells() const { return this->_totalAvailableCells; }
+
+int Board::availableCellNumber(int index) const { return index + this->_availableCellOffsets[index]; }
+
+void Board::readAvailableCellNumbers(std::vector<int>& cellNumbers) const {
+    cellNumbers.resize(this->_totalAvailableCells);
+    this->_availableCellOffsets.read(0, cellNumbers.size(), cellNumbers.data());
+
+    for (int i = 0; i < this->_totalAvailableCells; i++) cellNumbers[i] += i;
+}
+
+bool Board::isCellAvailable(int cellNumber) const {
+    return cellNumber >= 0 
+        && cellNumber < static_cast<int>(this->_grid.size()) 
+        && this->_grid[cellNumber] == 0;
+}
+
+int Board::cellPlayerNumber(int cellNumber) const { return this->_grid[cellNumber]; }
+
+size_t Board::totalMarkedCells() const { return this->_markedCells.size(); }
+
+int Board::markedCellNumber(size_t moveIndex) const { return this->_markedCells.at(moveIndex).cellNumber; }
+
+ConnectedCell Board::findConnectedCell(int row, int column, int targetPlayerNumber, int maxChain) const {
+    INSTRUMENT(Instrumentation::threadCounters().connectedCellLookups++;)
+
+    //Sum each chain with their opposite direction — top and down, etc. — before totaling them all.
+    //Because we don't want zig-zagging to count as connected cells.
+    //Also imagine a case where user chained a character (x) between left (x1) and right (x2).
+    //    [ x1 ][ x ][ x2 ]
+    //Horizontal chain would be (x) with (x1), and (x) with (x2),
+    //hence we have two chains here and it's valid to be count as three connected cells.
+
+    const int verticalChain = this->_countCurrentTopChain(row, column, targetPlayerNumber, maxChain)
+        + this->_countCurrentBottomChain(row, column, targetPlayerNumber, maxChain);
+    const int horizontalChain = this->_countCurrentLeftChain(row, column, targetPlayerNumber, maxChain)
+        + this->_countCurrentRightChain(row, column, targetPlayerNumber, maxChain);
+    const int diagonalLeftChain = this->_countTopLeftChain(row, column, targetPlayerNumber, maxChain)
+        + this->_countBottomRightChain(row, column, targetPlayerNumber, maxChain);
+    const int diagonalRightChain = this->_countTopRightChain(row, column, targetPlayerNumber, maxChain)
+        + this->_countBottomLeftChain(row, column, targetPlayerNumber, maxChain);
+
+    return this->_connectedCellByChains(
+        row, 
+        column, 
+        verticalChain, 
+        horizontalChain, 
+        diagonalLeftChain, 
+        diagonalRightChain);
+}
+
+void Board::findChainMap(int targetPlayerNumber, ChainMap& chainMap) const {
+    const int size = this->_gridSize;
+    const uint8_t target = static_cast<uint8_t>(targetPlayerNumber);
+
+    chainMap.vertical.assign(this->_grid.size());
+    chainMap.horizontal.assign(this->_grid.size());
+    chainMap.diagonalLeft.assign(this->_grid.size());
+    chainMap.diagonalRight.assign(this->_grid.size());
+
+    //Runs of the previous and current row, padded by one zero on both ends.
+    //So that diagonal runs coming from outside the grid can be read without bound checks.
+    std::vector<uint16_t> runs(6 * (size + 2), 0);
+    uint16_t* previousRuns[3] = { &runs[0], &runs[size + 2], &runs[2 * (size + 2)] };
+    uint16_t* currentRuns[3] = { &runs[3 * (size + 2)], &runs[4 * (size + 2)], &runs[5 * (size + 2)] };
+    //Current row of the grid and its chains, since rows of the chunks aren't contiguous.
+    std::vector<uint8_t> cells(size);
+    std::vector<uint16_t> chains(4 * size);
+    uint16_t* const verticalChains = &chains[0];
+    uint16_t* const horizontalChains = &chains[size];
+    uint16_t* const diagonalLeftChains = &chains[2 * size];
+    uint16_t* const diagonalRightChains = &chains[3 * size];
+
+    //First pass goes downward, adding top, top left and top right chains.
+    for (int row = 0; row < size; row++) {
+        const int offset = row * size;
+
+        this->_grid.read(offset, size, cells.data());
+        std::fill(chains.begin(), chains.end(), 0);
+
+        Board::_scanChainRow(
+            cells.data(), 
+            target, 
+            size,
+            previousRuns[0] + 1, 
+            previousRuns[1], 
+            previousRuns[2] + 2,
+            currentRuns[0] + 1, 
+            currentRuns[1] + 1, 
+            currentRuns[2] + 1,
+            verticalChains, 
+            diagonalLeftChains, 
+            diagonalRightChains);
+
+        //Horizontal chains depend on the cell before them, so it's only scanned once per row.
+        for (int column = 0, run = 0; column < size; column++) {
+            horizontalChains[column] = run;
+            run = cells[column] == target ? run + 1 : 0;
+        }
+
+        for (int column = size - 1, run = 0; column >= 0; column--) {
+            horizontalChains[column] += run;
+            run = cells[column] == target ? run + 1 : 0;
+        }
+
+        chainMap.vertical.write(offset, size, verticalChains);
+        chainMap.horizontal.write(offset, size, horizontalChains);
+        chainMap.diagonalLeft.write(offset, size, diagonalLeftChains);
+        chainMap.diagonalRight.write(offset, size, diagonalRightChains);
+        std::swap(previousRuns, currentRuns);
+    }
+
+    std::fill(runs.begin(), runs.end(), 0);
+
+    //Second pass goes upward, adding bottom, bottom right and bottom left chains.
+    for (int row = size - 1; row >= 0; row--) {
+        const int offset = row * size;
+
+        this->_grid.read(offset, size, cells.data());
+        chainMap.vertical.read(offset, size, verticalChains);
+        chainMap.diagonalLeft.read(offset, size, diagonalLeftChains);
+        chainMap.diagonalRight.read(offset, size, diagonalRightChains);
+
+        Board::_scanChainRow(
+            cells.data(), 
+            target, 
+            size,
+            previousRuns[0] + 1, 
+            previousRuns[1] + 2, 
+            previousRuns[2],
+            currentRuns[0] + 1, 
+            currentRuns[1] + 1, 
+            currentRuns[2] + 1,
+            verticalChains, 
+            diagonalLeftChains, 
+            diagonalRightChains);
+
+        chainMap.vertical.write(offset, size, verticalChains);
+        chainMap.diagonalLeft.write(offset, size, diagonalLeftChains);
+        chainMap.diagonalRight.write(offset, size, diagonalRightChains);
+        std::swap(previousRuns, currentRuns);
+    }
+}
+
+const ChainMap& Board::chainMap(int playerNumber) const { return this->_chainMaps.at(playerNumber - 1); }
+
+ConnectedCell Board::connectedCellByChainMap(ChainMap const& chainMap, int cellNumber) const {
+    INSTRUMENT(Instrumentation::threadCounters().connectedCellLookups++;)
+
+    return this->_connectedCellByChains(
+        cellNumber / this->_gridSize,
+        cellNumber % this->_gridSize,
+        chainMap.vertical[cellNumber],
+        chainMap.horizontal[cellNumber],
+        chainMap.diagonalLeft[cellNumber],
+        chainMap.diagonalRight[cellNumber]);
+}
+
+void Board::keepWindows() {
+    if (this->_isKeepingWindows) return;
+
+    this->_isKeepingWindows = true;
+    this->_markedWindows.assign(this->_grid.size());
+    this->_playerWindows.assign(this->_players.size(), ChunkedCells<uint32_t>(this->_grid.size()));
+
+    for (const MarkedCell& markedCell : this->_markedCells) {
+        this->_toggleWindows(markedCell.cellNumber, this->_grid[markedCell.cellNumber]);
+    }
+}
+
+bool Board::isKeepingWindows() const { return this->_isKeepingWindows; }
+
+uint32_t Board::markedWindow(int cellNumber) const { return this->_markedWindows[cellNumber]; }
+
+uint32_t Board::playerWindow(int playerNumber, int cellNumber) const { 
+    return this->_playerWindows[playerNumber - 1][cellNumber]; 
+}
+
+std::string Board::scoreText() const {
+    std::ostringstream text;
+    text << "Score: \n";
+
+    for (size_t i = 0; i < this->_players.size(); i++) {
+        Player& player = *this->_players.at(i);   
+        text << player.name() << "-" << i + 1 << " (" << player.marker() << "): " << this->_scores.at(i) << "\n";
+    }
+
+    return text.str();
+}
+
+const std::string& Board::gridLayoutText() const {
+    if (this->_gridLayout.empty()) this->_renderGridLayout();
+
+    return this->_gridLayout;
+}
+
+void Board::appendGridRenderText(std::string& text, int line) const {
+    const int cellLine = this->_cellLayoutLength();
+
+    if (this->_gridLayout.empty()) this->_renderGridLayout();
+
+    if (line != this->_renderedGridLine) {
+        //Erase anything below, since the previous grid could be somewhere else.
+        text += "\033[" + std::to_string(line) + ";1H\033[J";
+        text += this->_gridLayout;
+    } else {
+        for (int cell : this->_changedCells) {
+            const int row = line + this->rowByCellNumber(cell) * 2 + 1;
+            const int column = 3 + this->columnByCellNumber(cell) * (this->_cellWidth() + 3);
+
+            text += "\033[" + std::to_string(row) + ";" + std::to_string(column) + "H";
+            text.append(this->_gridLayout, this->_gridLayoutOffset(cell), cellLine);
+        }
+
+        text += "\033[" + std::to_string(line + this->_gridSize * 2 + 1) + ";1H";
+    }
+
+    this->_changedCells.clear();
+    this->_renderedGridLine = line;
+}
+
+std::string Board::moveHistoryText(size_t totalMoves) const {
+    std::ostringstream text;
+    const size_t firstMove = this->_markedCells.size() - std::min(totalMoves, this->_markedCells.size());
+
+    for (size_t i = firstMove; i < this->_markedCells.size(); i++) {
+        const MarkedCell& markedCell = this->_markedCells[i];
+        Player& player = *this->_players.at(this->_grid[markedCell.cellNumber] - 1);
+
+        text << player.name() << "-" << player.number() << " (" << player.marker() << ") selected '" 
+            << markedCell.cellNumber << "'";
+
+        if (markedCell.points > 0) text << ", gained +" << markedCell.points << " points";
+
+        text << "\n\n";
+    }
+
+    return text.str();
+}
+
+std::string Board::playerTurnText() const {
+    if (this->_playerTurn == nullptr) throw std::runtime_error("Player turn hasn't been set.");
+
+    std::ostringstream text;
+    text << this->_playerTurn->name() << "-" << this->_playerTurn->number() 
+        << " (" << this->_playerTurn->marker() << ") turn...\n";
+
+    return text.str();
+}
+
+std::string Board::resultText() const {
+    const std::shared_ptr<Player> topPlayer = this->winner();
+    std::ostringstream winText;
+    const std::string drawText = "Game over! The game ends with draw.\n";
+
+    if (topPlayer == nullptr) return drawText;
+
+    winText << "Game over! " << topPlayer->name() << "-" << topPlayer->number()
+        << " (" << topPlayer->marker() << ") has won!\n";  	
+    return winText.str();
+}
+
+std::shared_ptr<Player> Board::winner() const {
+    std::shared_ptr<Player> topPlayer = nullptr;
+    int topScore = 0;
+
+    for (const std::shared_ptr<Player>& player : this->_players) {
+        const int score = this->_scores.at(player->number() - 1);
+
+        if (score > topScore) {
+            topPlayer = player;
+            topScore = score;
+            
+        //Remove top player if multiple player have equal score.
+        } else if (score == topScore) {
+            topPlayer = nullptr;
+        }
+    }
+
+    return topPlayer;
+}
+
+bool Board::markCellByNumber(int cellNumber, int playerNumber) {
+    const int x = this->columnByCellNumber(cellNumber);
+    const int y = this->rowByCellNumber(cellNumber);
+
+    if (x < 0 
+        || x >= this->_gridSize 
+        || y < 0 
+        || y >= this->_gridSize
+        || this->_grid[cellNumber] != 0
+        || this->_playerTurn == nullptr) {
+        return false;
+    }
+
+    this->applyMove(cellNumber, playerNumber);
+    this->_changedCells.push_back(cellNumber);
+    this->_renderCell(cellNumber);
+    this->_highlightChainAround(cellNumber, playerNumber);
+    return true;
+}
+
+int Board::applyMove(int cellNumber, int playerNumber) {
+    this->_grid.set(cellNumber, static_cast<uint8_t>(playerNumber));
+    this->_toggleHash(cellNumber, playerNumber);
+
+    //Swap the cell with the last available one, so it can be removed without shifting others.
+    //Its index is kept as is, so that it can be swapped back when the move is reverted.
+    const int index = this->_availableCellIndex(cellNumber);
+    this->_totalAvailableCells--;
+    this->_placeAvailableCell(index, this->availableCellNumber(this->_totalAvailableCells));
+
+    //Chains of the marked cell are still the ones from before it was marked.
+    const int totalConnected = this->connectedCellByChainMap(
+        this->_chainMaps.at(playerNumber - 1), 
+        cellNumber).totalConnected;
+
+    this->_extendChainMap(cellNumber, playerNumber);
+    if (this->_isKeepingWindows) this->_toggleWindows(cellNumber, playerNumber);
+    this->_markedCells.push_back(MarkedCell { cellNumber, totalConnected });
+    this->_scores[playerNumber - 1] += totalConnected;
+    this->_totalScoringMoves += totalConnected > 0;
+    return totalConnected;
+}
+
+void Board::undoMove() {
+    if (this->_markedCells.empty()) throw std::runtime_error("There's no move to undo.");
+
+    const int cellNumber = this->_markedCells.back().cellNumber;
+    const int playerNumber = this->_grid[cellNumber];
+    const int index = this->_availableCellIndex(cellNumber);
+
+    this->_scores[playerNumber - 1] -= this->_markedCells.back().points;
+    this->_totalScoringMoves -= this->_markedCells.back().points > 0;
+    this->_markedCells.pop_back();
+    this->_totalSnapshotMoves = std::min(this->_totalSnapshotMoves, this->_markedCells.size());
+    this->_toggleHash(cellNumber, playerNumber);
+    this->_retractChainMap(cellNumber, playerNumber);
+    if (this->_isKeepingWindows) this->_toggleWindows(cellNumber, playerNumber);
+    this->_grid.set(cellNumber, 0);
+
+    //Swap back the cell which took its place, unless it was the last one.
+    if (index != this->_totalAvailableCells) {
+        this->_placeAvailableCell(this->_totalAvailableCells, this->availableCellNumber(index));
+    }
+
+    this->_placeAvailableCell(index, cellNumber);
+    this->_totalAvailableCells++;
+}
+
+int Board::score(int playerNumber) const { return this->_scores.at(playerNumber - 1); }
+
+uint64_t Board::hash() const { return this->_hashes[0]; }
+
+uint64_t Board::canonicalHash(int& symmetry) const {
+    symmetry = 0;
+
+    for (int i = 1; i < this->_totalSymmetries; i++) {
+        if (this->_hashes[i] < this->_hashes[symmetry]) symmetry = i;
+    }
+
+    return this->_hashes[symmetry];
+}
+
+int Board::symmetricCellNumber(int cellNumber, int symmetry) const {
+    int row = this->rowByCellNumber(cellNumber);
+    int column = this->columnByCellNumber(cellNumber);
+
+    //Each bit of the symmetry is a transformation, 
+    //combined they make up every rotation and reflection of a square.
+    if (symmetry & 4) std::swap(row, column);
+    if (symmetry & 1) column = this->_gridSize - 1 - column;
+    if (symmetry & 2) row = this->_gridSize - 1 - row;
+
+    return this->cellNumberByPosition(row, column);
+}
+
+int Board::cellNumberBySymmetry(int symmetricCellNumber, int symmetry) const {
+    int row = this->rowByCellNumber(symmetricCellNumber);
+    int column = this->columnByCellNumber(symmetricCellNumber);
+
+    if (symmetry & 2) row = this->_gridSize - 1 - row;
+    if (symmetry & 1) column = this->_gridSize - 1 - column;
+    if (symmetry & 4) std::swap(row, column);
+
+    return this->cellNumberByPosition(row, column);
+}
+
+uint64_t Board::zobristKey(int cellNumber, int playerNumber) {
+    //SplitMix64 finalizer over the cell and player, rather than a table of random keys.
+    //So the keys are the same on every run and don't take memory on big grids.
+    uint64_t key = (static_cast<uint64_t>(cellNumber + 1) << 8 | playerNumber) + 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+void Board::reset() {
+    this->_grid.reset();
+    this->_markedCells.clear();
+    this->_hashes.fill(0);
+    this->_totalAvailableCells = this->_grid.size();
+    this->_availableCellOffsets.reset();
+    this->_availableCellIndexOffsets.reset();
+    this->_playerTurn = nullptr;
+
+    for (ChainMap& chainMap : this->_chainMaps) {
+        chainMap.vertical.reset();
+        chainMap.horizontal.reset();
+        chainMap.diagonalLeft.reset();
+        chainMap.diagonalRight.reset();
+    }
+
+    this->_markedWindows.reset();
+
+    for (ChunkedCells<uint32_t>& playerWindows : this->_playerWindows) playerWindows.reset();
+
+    this->_highlightedCells.reset();
+    this->_gridLayout.clear();
+    this->_changedCells.clear();
+    this->_renderedGridLine = 0;
+
+    std::fill(this->_scores.begin(), this->_scores.end(), 0);
+    this->_totalScoringMoves = 0;
+    this->_snapshotSegment = nullptr;
+    this->_totalSnapshotMoves = 0;
+}
+
+BoardSnapshot Board::snapshot() const {
+    std::shared_ptr<const BoardSnapshot::Segment> segment = this->_snapshotSegment;
+    BoardSnapshot snapshot {};
+
+    //Segments starting past the moves this board still has in common are dropped.
+    while (segment != nullptr && segment->firstMove >= this->_totalSnapshotMoves) segment = segment->parent;
+
+    size_t totalSharedMoves = segment == nullptr ? 0 : segment->firstMove + segment->moves.size();
+
+    //Taken again from its start when only part of it is in common.
+    if (totalSharedMoves > this->_totalSnapshotMoves) {
+        totalSharedMoves = segment->firstMove;
+        segment = segment->parent;
+    }
+
+    if (totalSharedMoves < this->_markedCells.size()) {
+        std::shared_ptr<BoardSnapshot::Segment> nextSegment = std::make_shared<BoardSnapshot::Segment>();
+        nextSegment->parent = segment;
+        nextSegment->firstMove = totalSharedMoves;
+        nextSegment->moves.reserve(this->_markedCells.size() - totalSharedMoves);
+
+        for (size_t i = totalSharedMoves; i < this->_markedCells.size(); i++) {
+            const int cellNumber = this->_markedCells[i].cellNumber;
+            nextSegment->moves.push_back(BoardSnapshot::Move { cellNumber, this->_grid[cellNumber] });
+        }
+
+        segment = nextSegment;
+    }
+
+    this->_snapshotSegment = segment;
+    this->_totalSnapshotMoves = this->_markedCells.size();
+
+    snapshot._segment = segment;
+    snapshot._playerTurnNumber = this->_playerTurn == nullptr ? 0 : this->_playerTurn->number();
+    snapshot._engine = this->_engine;
+    snapshot._boardType = &typeid(*this);
+    snapshot._gridSize = this->_gridSize;
+    snapshot._totalPlayers = this->_players.size();
+    return snapshot;
+}
+
+bool Board::restore(BoardSnapshot const& snapshot) {
+    if (snapshot._boardType == nullptr
+        || *snapshot._boardType != typeid(*this) 
+        || snapshot._gridSize != this->_gridSize 
+        || snapshot._totalPlayers != this->_players.size()) {
+        return false;
+    }
+
+    const size_t totalCommonMoves = std::min(
+        this->_totalSnapshotMoves, 
+        BoardSnapshot::_totalCommonMoves(this->_snapshotSegment.get(), snapshot._segment.get()));
+    //Segments holding the moves to mark, from the latest one.
+    std::vector<BoardSnapshot::Segment const*> segments {};
+
+    while (this->_markedCells.size() > totalCommonMoves) {
+        const int cellNumber = this->_markedCells.back().cellNumber;
+        const int playerNumber = this->_grid[cellNumber];
+
+        this->undoMove();
+        this->_unhighlightChainAround(cellNumber, playerNumber);
+        this->_changedCells.push_back(cellNumber);
+        this->_renderCell(cellNumber);
+    }
+
+    for (const BoardSnapshot::Segment* segment = snapshot._segment.get(); 
+        segment != nullptr && segment->firstMove + segment->moves.size() > totalCommonMoves; 
+        segment = segment->parent.get()) {
+        segments.push_back(segment);
+    }
+
+    for (std::vector<BoardSnapshot::Segment const*>::reverse_iterator it = segments.rbegin(); it != segments.rend(); it++) {
+        for (size_t i = std::max((*it)->firstMove, totalCommonMoves) - (*it)->firstMove; i < (*it)->moves.size(); i++) {
+            const BoardSnapshot::Move& move = (*it)->moves[i];
+
+            this->applyMove(move.cellNumber, move.playerNumber);
+            this->_changedCells.push_back(move.cellNumber);
+            this->_renderCell(move.cellNumber);
+            this->_highlightChainAround(move.cellNumber, move.playerNumber);
+        }
+    }
+
+    this->_playerTurn = snapshot._playerTurnNumber == 0 ? nullptr : this->_players.at(snapshot._playerTurnNumber - 1);
+    this->_engine = snapshot._engine;
+    this->_snapshotSegment = snapshot._segment;
+    this->_totalSnapshotMoves = this->_markedCells.size();
+    return true;
+}
+
+void Board::togglePlayerTurn() {
+    int playerTurnIndex = this->_playerTurn == nullptr ? -1 : this->_playerTurn->number() - 1;
+
+    //Only randomly pick the turn during initial run. 
+    //From then on, it's incremented from previous player index.
+    if (playerTurnIndex == -1) {
+        playerTurnIndex = this->_engine.below(this->_players.size());
+
+    } else if (playerTurnIndex + 1 >= this->_players.size()) {
+        playerTurnIndex = 0;
+    } else {
+        playerTurnIndex++;
+    }
+
+    this->_playerTurn = this->_players.at(playerTurnIndex);
+}
+
+void Board::setPlayerTurn(int playerNumber) { this->_playerTurn = this->_players.at(playerNumber - 1); }
+
+RandomEngine& Board::random() const { return this->_engine; }
+
+void Board::seed(uint64_t seed) { this->_engine.seed(seed); }
+
+int Board::requireGridSelection() const {
+    std::shared_ptr<Screen> screen = this->_screen.lock();
+    if (!screen) throw std::runtime_error("Weak pointer expired.");
+
+    const int maxCell = std::max(0, (this->_gridSize * this->_gridSize) - 1);
+    const int maxRowOrColumn = std::max(0, this->_gridSize - 1);
+    int selectedCell = -1;
+    std::string invalidText = "";
+
+    while (true) {
+        std::string line;
+
+        screen->beginFrame();
+        screen->appendGameFrame(*this);
+        screen->appendFrameSection(this->playerTurnText() + invalidText);
+        screen->appendFrameSection("Select cell by number: ");
+        screen->writeFrame();
+        std::getline(std::cin, line);
+
+        std::stringstream lineStream(line);
+
+        if (lineStream >> selectedCell && lineStream.eof()) {
+            const int x = this->columnByCellNumber(selectedCell);
+            const int y = this->rowByCellNumber(selectedCell);
+
+            if (selectedCell >= 0
+                && selectedCell <= maxCell
+                && x >= 0 
+                && x <= maxRowOrColumn
+                && y >= 0 
+                && y <= maxRowOrColumn
+                && this->_grid[selectedCell] == 0) {
+                break;
+            }
+        }
+
+        selectedCell = -1;
+        invalidText = "\n** Invalid cell number, please reselect!\n";
+    }
+
+    return selectedCell;
+}
+
+bool Board::requireRematch() {
+    std::string line;
+
+    std::cout << "Rematch? (y/n) ";
+    std::getline(std::cin, line);
+    std::cout << "\n";
+
+    for (char& ch : line) ch = std::tolower(ch);
+
+    return line == "y" || line == "yes";
+}
+
+void Board::_scanChainRow(
+    const uint8_t* cells,
+    uint8_t targetPlayerNumber,
+    int count,
+    const uint16_t* previousVerticalRun,
+    const uint16_t* previousDiagonalLeftRun,
+    const uint16_t* previousDiagonalRightRun,
+    uint16_t* verticalRun,
+    uint16_t* diagonalLeftRun,
+    uint16_t* diagonalRightRun,
+    uint16_t* verticalChain,
+    uint16_t* diagonalLeftChain,
+    uint16_t* diagonalRightChain) {
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256i target = _mm256_set1_epi16(targetPlayerNumber);
+    const __m256i one = _mm256_set1_epi16(1);
+
+    for (; i + 16 <= count; i += 16) {
+        const __m256i cell = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i)));
+        const __m256i isTarget = _mm256_cmpeq_epi16(cell, target);
+        const __m256i vertical = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previousVerticalRun + i));
+        const __m256i diagonalLeft = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previousDiagonalLeftRun + i));
+        const __m256i diagonalRight = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previousDiagonalRightRun + i));
+        __m256i* verticalChainLane = reinterpret_cast<__m256i*>(verticalChain + i);
+        __m256i* diagonalLeftChainLane = reinterpret_cast<__m256i*>(diagonalLeftChain + i);
+        __m256i* diagonalRightChainLane = reinterpret_cast<__m256i*>(diagonalRightChain + i);
+
+        _mm256_storeu_si256(verticalChainLane, _mm256_add_epi16(_mm256_loadu_si256(verticalChainLane), vertical));
+        _mm256_storeu_si256(diagonalLeftChainLane, _mm256_add_epi16(_mm256_loadu_si256(diagonalLeftChainLane), diagonalLeft));
+        _mm256_storeu_si256(diagonalRightChainLane, _mm256_add_epi16(_mm256_loadu_si256(diagonalRightChainLane), diagonalRight));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(verticalRun + i), _mm256_and_si256(isTarget, _mm256_add_epi16(vertical, one)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(diagonalLeftRun + i), _mm256_and_si256(isTarget, _mm256_add_epi16(diagonalLeft, one)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(diagonalRightRun + i), _mm256_and_si256(isTarget, _mm256_add_epi16(diagonalRight, one)));
+    }
+#elif defined(__SSE2__)
+    const __m128i target = _mm_set1_epi16(targetPlayerNumber);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 8 <= count; i += 8) {
+        const __m128i cell = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cells + i)), zero);
+        const __m128i isTarget = _mm_cmpeq_epi16(cell, target);
+        const __m128i vertical = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previousVerticalRun + i));
+        const __m128i diagonalLeft = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previousDiagonalLeftRun + i));
+        const __m128i diagonalRight = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previousDiagonalRightRun + i));
+        __m128i* verticalChainLane = reinterpret_cast<__m128i*>(verticalChain + i);
+        __m128i* diagonalLeftChainLane = reinterpret_cast<__m128i*>(diagonalLeftChain + i);
+        __m128i* diagonalRightChainLane = reinterpret_cast<__m128i*>(diagonalRightChain + i);
+
+        _mm_storeu_si128(verticalChainLane, _mm_add_epi16(_mm_loadu_si128(verticalChainLane), vertical));
+        _mm_storeu_si128(diagonalLeftChainLane, _mm_add_epi16(_mm_loadu_si128(diagonalLeftChainLane), diagonalLeft));
+        _mm_storeu_si128(diagonalRightChainLane, _mm_add_epi16(_mm_loadu_si128(diagonalRightChainLane), diagonalRight));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(verticalRun + i), _mm_and_si128(isTarget, _mm_add_epi16(vertical, one)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(diagonalLeftRun + i), _mm_and_si128(isTarget, _mm_add_epi16(diagonalLeft, one)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(diagonalRightRun + i), _mm_and_si128(isTarget, _mm_add_epi16(diagonalRight, one)));
+    }
+#elif defined(__ARM_NEON)
+    const uint16x8_t target = vdupq_n_u16(targetPlayerNumber);
+    const uint16x8_t one = vdupq_n_u16(1);
+
+    for (; i + 8 <= count; i += 8) {
+        const uint16x8_t isTarget = vceqq_u16(vmovl_u8(vld1_u8(cells + i)), target);
+        const uint16x8_t vertical = vld1q_u16(previousVerticalRun + i);
+        const uint16x8_t diagonalLeft = vld1q_u16(previousDiagonalLeftRun + i);
+        const uint16x8_t diagonalRight = vld1q_u16(previousDiagonalRightRun + i);
+
+        vst1q_u16(verticalChain + i, vaddq_u16(vld1q_u16(verticalChain + i), vertical));
+        vst1q_u16(diagonalLeftChain + i, vaddq_u16(vld1q_u16(diagonalLeftChain + i), diagonalLeft));
+        vst1q_u16(diagonalRightChain + i, vaddq_u16(vld1q_u16(diagonalRightChain + i), diagonalRight));
+        vst1q_u16(verticalRun + i, vandq_u16(isTarget, vaddq_u16(vertical, one)));
+        vst1q_u16(diagonalLeftRun + i, vandq_u16(isTarget, vaddq_u16(diagonalLeft, one)));
+        vst1q_u16(diagonalRightRun + i, vandq_u16(isTarget, vaddq_u16(diagonalRight, one)));
+    }
+#endif
+
+    //Scalar fallback, also used for the remaining cells which don't fill a whole vector.
+    for (; i < count; i++) {
+        const bool isTarget = cells[i] == targetPlayerNumber;
+
+        verticalChain[i] += previousVerticalRun[i];
+        diagonalLeftChain[i] += previousDiagonalLeftRun[i];
+        diagonalRightChain[i] += previousDiagonalRightRun[i];
+        verticalRun[i] = isTarget ? previousVerticalRun[i] + 1 : 0;
+        diagonalLeftRun[i] = isTarget ? previousDiagonalLeftRun[i] + 1 : 0;
+        diagonalRightRun[i] = isTarget ? previousDiagonalRightRun[i] + 1 : 0;
+    }
+}
+
+void Board::_toggleHash(int cellNumber, int playerNumber) {
+    for (int i = 0; i < this->_totalSymmetries; i++) {
+        this->_hashes[i] ^= Board::zobristKey(this->symmetricCellNumber(cellNumber, i), playerNumber);
+    }
+}
+
+int Board::_cellWidth() const {
+    //Wide enough for the biggest cell number, but not narrower than the original two characters.
+    int width = 1;
+    for (int n = this->_gridSize * this->_gridSize - 1; n >= 10; n /= 10) width++;
+
+    return std::max(2, width);
+}
+
+int Board::_cellLayoutLength() const { return TextColor::CYAN.size() + this->_cellWidth() + TextColor::DEFAULT.size(); }
+
+int Board::_availableCellIndex(int cellNumber) const { 
+    return cellNumber + this->_availableCellIndexOffsets[cellNumber]; 
+}
+
+void Board::_placeAvailableCell(int index, int cellNumber) {
+    this->_availableCellOffsets.set(index, cellNumber - index);
+    this->_availableCellIndexOffsets.set(cellNumber, index - cellNumber);
+}
+
+size_t Board::_gridLayoutOffset(int cellNumber) const {
+    //Each separator line is one strip longer than the cells, followed by a new line.
+    const size_t separatorLine = this->_gridSize * (this->_cellWidth() + 3) + 2;
+    //Each cell line starts with "| ", each cell is followed by " | " and the line ends with a new line.
+    const size_t cellLine = 2 + this->_gridSize * (this->_cellLayoutLength() + 3) + 1;
+    const size_t row = this->rowByCellNumber(cellNumber);
+    const size_t column = this->columnByCellNumber(cellNumber);
+
+    return (row + 1) * separatorLine + row * cellLine + 2 + column * (this->_cellLayoutLength() + 3);
+}
+
+void Board::_renderGridLayout() const {
+    //Note: Amount of strips here are equal to cell width + 2 space around + 1 pipe (|).
+    const std::string separator = std::string(this->_gridSize * (this->_cellWidth() + 3) + 1, '-') + "\n";
+    const std::string emptyCell = std::string(this->_cellLayoutLength(), ' ') + " | ";
+
+    this->_gridLayout.clear();
+
+    for (int y = 0; y < this->_gridSize; y++) {
+        this->_gridLayout += separator + "| ";
+        for (int x = 0; x < this->_gridSize; x++) this->_gridLayout += emptyCell;
+        this->_gridLayout += "\n";
+    }
+
+    this->_gridLayout += separator;
+
+    for (int cell = 0; cell < static_cast<int>(this->_grid.size()); cell++) this->_renderCell(cell);
+}
+
+void Board::_renderCell(int cellNumber) const {
+    if (this->_gridLayout.empty()) return;
+
+    const int width = this->_cellWidth();
+    const int playerNumber = this->_grid[cellNumber];
+    const std::string& color = this->_highlightedCells[cellNumber] ? TextColor::CYAN : TextColor::FOREGROUND;
+    char* const layout = &this->_gridLayout[this->_gridLayoutOffset(cellNumber)];
+    char* const text = layout + color.size();
+
+    std::memcpy(layout, color.data(), color.size());
+    std::fill(text, text + width, ' ');
+
+    //Display its cell number instead of empty cell, aligned to the right.
+    if (playerNumber == 0) {
+        char number[16];
+        const char* const numberEnd = std::to_chars(number, number + sizeof(number), cellNumber).ptr;
+        std::copy(static_cast<const char*>(number), numberEnd, text + width - (numberEnd - number));
+    } else {
+        const std::string& marker = this->_players.at(playerNumber - 1)->marker();
+        std::copy(marker.begin(), marker.end(), text + width - marker.size());
+    }
+
+    std::memcpy(text + width, TextColor::DEFAULT.data(), TextColor::DEFAULT.size());
+}
+
+void Board::_highlightChainAround(int cellNumber, int playerNumber) {
+    const int row = this->rowByCellNumber(cellNumber);
+    const int column = this->columnByCellNumber(cellNumber);
+    //Vertical, horizontal, diagonal-left and diagonal-right.
+    const int deltaRows[] = {1, 0, 1, 1};
+    const int deltaColumns[] = {0, 1, 1, -1};
+
+    for (int direction = 0; direction < 4; direction++) {
+        const int deltaRow = deltaRows[direction];
+        const int deltaColumn = deltaColumns[direction];
+        const int backwardChain = this->_countChainByDirection(
+            row, column, -deltaRow, -deltaColumn, playerNumber, std::numeric_limits<int>::max());
+        const int forwardChain = this->_countChainByDirection(
+            row, column, deltaRow, deltaColumn, playerNumber, std::numeric_limits<int>::max());
+
+        //Same as when counting connected cells, the run has to include current cell and two others.
+        if (backwardChain + forwardChain < 2) continue;
+
+        for (int i = -backwardChain; i <= forwardChain; i++) {
+            const int cell = this->cellNumberByPosition(row + deltaRow * i, column + deltaColumn * i);
+            if (this->_highlightedCells[cell]) continue;
+
+            this->_highlightedCells.set(cell, 1);
+            this->_changedCells.push_back(cell);
+            this->_renderCell(cell);
+        }
+    }
+}
+
+void Board::_unhighlightChainAround(int cellNumber, int playerNumber) {
+    const int row = this->rowByCellNumber(cellNumber);
+    const int column = this->columnByCellNumber(cellNumber);
+    //Vertical, horizontal, diagonal-left and diagonal-right.
+    const int deltaRows[] = {1, 0, 1, 1};
+    const int deltaColumns[] = {0, 1, 1, -1};
+
+    if (this->_highlightedCells[cellNumber]) this->_highlightedCells.set(cellNumber, 0);
+
+    //Only cells of the same player running from the reverted cell could have been chained through it.
+    for (int direction = 0; direction < 4; direction++) {
+        for (int sign : { -1, 1 }) {
+            const int deltaRow = deltaRows[direction] * sign;
+            const int deltaColumn = deltaColumns[direction] * sign;
+
+            for (int i = 1; ; i++) {
+                const int cellRow = row + deltaRow * i;
+                const int cellColumn = column + deltaColumn * i;
+
+                if (cellRow < 0 || cellRow >= this->_gridSize || cellColumn < 0 || cellColumn >= this->_gridSize) break;
+
+                const int cell = this->cellNumberByPosition(cellRow, cellColumn);
+                if (this->_grid[cell] != playerNumber) break;
+                if (!this->_highlightedCells[cell] || this->_isCellChained(cell)) continue;
+
+                this->_highlightedCells.set(cell, 0);
+                this->_changedCells.push_back(cell);
+                this->_renderCell(cell);
+            }
+        }
+    }
+}
+
+bool Board::_isCellChained(int cellNumber) const {
+    const int row = this->rowByCellNumber(cellNumber);
+    const int column = this->columnByCellNumber(cellNumber);
+    const int playerNumber = this->_grid[cellNumber];
+    const int deltaRows[] = {1, 0, 1, 1};
+    const int deltaColumns[] = {0, 1, 1, -1};
+
+    for (int direction = 0; direction < 4; direction++) {
+        const int backwardChain = this->_countChainByDirection(
+            row, column, -deltaRows[direction], -deltaColumns[direction], playerNumber, 2);
+        const int forwardChain = this->_countChainByDirection(
+            row, column, deltaRows[direction], deltaColumns[direction], playerNumber, 2);
+
+        if (backwardChain + forwardChain >= 2) return true;
+    }
+
+    return false;
+}
+
+void Board::_extendChainMap(int cellNumber, int playerNumber) {
+    this->_addChainAroundRuns(cellNumber, playerNumber, 1);
+}
+
+void Board::_retractChainMap(int cellNumber, int playerNumber) {
+    this->_addChainAroundRuns(cellNumber, playerNumber, -1);
+}
+
+void Board::_addChainAroundRuns(int cellNumber, int playerNumber, int sign) {
+    struct Axis {
+        int deltaRow;
+        int deltaColumn;
+        ChunkedCells<uint16_t> ChainMap::* chains;
+    };
+    static const Axis axes[] = {
+        { 1, 0, &ChainMap::vertical },
+        { 0, 1, &ChainMap::horizontal },
+        { 1, 1, &ChainMap::diagonalLeft },
+        { 1, -1, &ChainMap::diagonalRight }
+    };
+
+    ChainMap& chainMap = this->_chainMaps.at(playerNumber - 1);
+    const int row = this->rowByCellNumber(cellNumber);
+    const int column = this->columnByCellNumber(cellNumber);
+
+    for (const Axis& axis : axes) {
+        ChunkedCells<uint16_t>& chains = chainMap.*axis.chains;
+        const int backwardChain = this->_countChainByDirection(
+            row, 
+            column, 
+            -axis.deltaRow, 
+            -axis.deltaColumn, 
+            playerNumber, 
+            std::numeric_limits<int>::max());
+        const int forwardChain = this->_countChainByDirection(
+            row, 
+            column, 
+            axis.deltaRow, 
+            axis.deltaColumn, 
+            playerNumber, 
+            std::numeric_limits<int>::max());
+
+        //Cell right before the run now also chains through marked cell and everything after it.
+        const int backwardRow = row - (backwardChain + 1) * axis.deltaRow;
+        const int backwardColumn = column - (backwardChain + 1) * axis.deltaColumn;
+
+        if (backwardRow >= 0 
+            && backwardRow < this->_gridSize
+            && backwardColumn >= 0 
+            && backwardColumn < this->_gridSize
+            && this->_grid[backwardRow * this->_gridSize + backwardColumn] == 0) {
+            const int cell = backwardRow * this->_gridSize + backwardColumn;
+            chains.set(cell, chains[cell] + sign * (forwardChain + 1));
+        }
+
+        //And the same goes for the cell right after the run.
+        const int forwardRow = row + (forwardChain + 1) * axis.deltaRow;
+        const int forwardColumn = column + (forwardChain + 1) * axis.deltaColumn;
+
+        if (forwardRow >= 0 
+            && forwardRow < this->_gridSize
+            && forwardColumn >= 0 
+            && forwardColumn < this->_gridSize
+            && this->_grid[forwardRow * this->_gridSize + forwardColumn] == 0) {
+            const int cell = forwardRow * this->_gridSize + forwardColumn;
+            chains.set(cell, chains[cell] + sign * (backwardChain + 1));
+        }
+    }
+}
+
+void Board::_toggleWindows(int cellNumber, int playerNumber) {
+    ChunkedCells<uint32_t>& playerWindows = this->_playerWindows[playerNumber - 1];
+    const int row = this->rowByCellNumber(cellNumber);
+    const int column = this->columnByCellNumber(cellNumber);
+    const int lastIndex = this->_gridSize - 1;
+    //Cells toward each edge within the window.
+    const int down = std::min(lastIndex - row, Board::WINDOW_RADIUS);
+    const int up = std::min(row, Board::WINDOW_RADIUS);
+    const int right = std::min(lastIndex - column, Board::WINDOW_RADIUS);
+    const int left = std::min(column, Board::WINDOW_RADIUS);
+    //In the order of directions within a window, along with their step as cell numbers.
+    const int insideCells[8] = { 
+        down, up, right, left, std::min(down, right), std::min(up, left), std::min(down, left), std::min(up, right) 
+    };
+    const int steps[8] = { 
+        this->_gridSize, -this->_gridSize, 1, -1, this->_gridSize + 1, -this->_gridSize - 1, 
+        this->_gridSize - 1, -this->_gridSize + 1
+    };
+
+    for (int direction = 0; direction < 8; direction++) {
+        //Seen from the cells along a direction, marked cell is toward the opposite one.
+        uint32_t bit = 1u << (Board::WINDOW_RADIUS * (direction ^ 1));
+        int cell = cellNumber;
+
+        for (int distance = 0; distance < insideCells[direction]; distance++) {
+            cell += steps[direction];
+            this->_markedWindows.flip(cell, bit);
+            playerWindows.flip(cell, bit);
+            bit <<= 1;
+        }
+    }
+}
+
+ConnectedCell Board::_connectedCellByChains(
+    int row,
+    int column,
+    int verticalChain,
+    int horizontalChain,
+    int diagonalLeftChain,
+    int diagonalRightChain) const {
+    int total = 0;
+
+    total += verticalChain >= 2 ? verticalChain + 1 : 0; //+1 to include current cell.
+    total += horizontalChain >= 2 ? horizontalChain + 1 : 0; //+1 to include current cell.
+    total += diagonalLeftChain >= 2 ? diagonalLeftChain + 1 : 0; //+1 to include current cell.
+    total += diagonalRightChain >= 2 ? diagonalRightChain + 1 : 0; //+1 to include current cell.
+
+    return ConnectedCell {
+        .row = row,
+        .column = column,
+        .verticalChain = verticalChain,
+        .horizontalChain = horizontalChain,
+        .diagonalLeftChain = diagonalLeftChain,
+        .diagonalRightChain = diagonalRightChain,
+        .totalConnected = total
+    };
+}
+
+int Board::_countChainByDirection(
+    int row, 
+    int column, 
+    int deltaRow, 
+    int deltaColumn, 
+    int targetPlayerNumber,
+    int maxChain) const {
+    int chain = 0;       
+
+    do {
+        row += deltaRow;
+        column += deltaColumn;
+
+        //The loop traverse in the specified direction until a different character 
+        //is encountered or the grid boundaries are reached.
+        if (row < 0 
+            || row >= this->_gridSize
+            || column < 0 
+            || column >= this->_gridSize
+            || this->_grid[row * this->_gridSize + column] != targetPlayerNumber) {
+            break;
+        }        
+
+        chain++;
+
+    } while (chain < maxChain);
+
+    return chain;
+}
+
+int Board::_countCurrentTopChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, -1, 0, targetPlayerNumber, maxChain);
+}
+
+int Board::_countCurrentBottomChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, 1, 0, targetPlayerNumber, maxChain);
+}
+
+int Board::_countCurrentLeftChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, 0, -1, targetPlayerNumber, maxChain);
+}
+
+int Board::_countCurrentRightChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, 0, 1, targetPlayerNumber, maxChain);
+}
+
+int Board::_countTopLeftChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, -1, -1, targetPlayerNumber, maxChain);
+}
+
+int Board::_countTopRightChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, -1, 1, targetPlayerNumber, maxChain);
+}
+
+int Board::_countBottomLeftChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, 1, -1, targetPlayerNumber, maxChain);
+}
+
+int Board::_countBottomRightChain(int row, int column, int targetPlayerNumber, int maxChain) const {
+    return this->_countChainByDirection(row, column, 1, 1, targetPlayerNumber, maxChain);
+}
+
+ClassicBoard::ClassicBoard(
+    std::shared_ptr<Screen> const screen, 
+    const std::vector<std::shared_ptr<Player>> players) : 
+    Board(screen, players, players.size() + 1) {
+    //Small enough to fold every symmetrical positions when looking ahead.
+    this->_totalSymmetries = 8;
+}
+
+const std::string ClassicBoard::nameAndDescription() {
+    const std::string title =  "Classic";
+    std::string text = title + "\n";
+
+    for (size_t i = 0; i < title.length(); i++) text += "-";
+
+    text += "\nConnect three characters to win the game.\n";
+    return text;
+}
+
+std::unique_ptr<Board> ClassicBoard::create(
+    std::shared_ptr<Screen> const screen, 
+    const std::vector<std::shared_ptr<Player>> players) {
+    switch (players.size() + 1) {
+        case 3: return std::make_unique<FixedClassicBoard<3>>(screen, players);
+        case 4: return std::make_unique<FixedClassicBoard<4>>(screen, players);
+        case 5: return std::make_unique<FixedClassicBoard<5>>(screen, players);
+        default: return std::make_unique<ClassicBoard>(screen, players);
+    }
+}
+
+std::unique_ptr<Board> ClassicBoard::clone() const { return std::make_unique<ClassicBoard>(*this); }
+
+bool ClassicBoard::isCompleted() const {
+    //Finish the game as soon someone scored.
+    return this->_totalAvailableCells == 0 || this->_totalScoringMoves > 0;
+}
+
+FrenzyBoard::FrenzyBoard(
+    std::shared_ptr<Screen> const screen, 
+    const std::vector<std::shared_ptr<Player>> players, 
+    int gridSize) : 
+    Board(screen, players, gridSize) {
+}
+
+const std::string FrenzyBoard::nameAndDescription() {
+    const std::string title =  "Frenzy";
+    std::string text = title + "\n";
+
+    for (size_t i = 0; i < title.length(); i++) text += "-";
+
+    text += "\nConnect three or more characters to earn points.\n"
+        "The one with the most points wins.\n";
+    return text;
+}
+
+bool FrenzyBoard::isCompleted() const { return this->_totalAvailableCells == 0; }
+
+std::unique_ptr<Board> FrenzyBoard::clone() const { return std::make_unique<FrenzyBoard>(*this); }
+
+std::unique_ptr<Board> GameRecord::createBoard(
+    std::shared_ptr<Screen> const screen, 
+    size_t totalMoves, 
+    SearchOptions const& searchOptions) const {
+    std::vector<std::shared_ptr<Player>> players {};
+
+    for (size_t i = 0; i < this->markers.size(); i++) {
+        const int number = static_cast<int>(i) + 1;
+
+        if (this->isBots.at(i)) players.push_back(std::make_shared<Bot>(number, this->markers.at(i), searchOptions));
+        else players.push_back(std::make_shared<Player>(number, this->markers.at(i)));
+    }
+
+    std::unique_ptr<Board> board = this->isFrenzy
+        ? std::make_unique<FrenzyBoard>(screen, players, this->gridSize)
+        : ClassicBoard::create(screen, players);
+
+    if (board->gridSize() != this->gridSize) throw std::runtime_error("Game record has a mismatched grid size.");
+
+    board->setPlayerTurn(this->firstPlayerNumber);
+
+    for (size_t i = 0; i < std::min(totalMoves, this->cellNumbers.size()); i++) {
+        const int cellNumber = this->cellNumbers[i];
+
+        if (board->isCompleted() || !board->isCellAvailable(cellNumber)) {
+            throw std::runtime_error("Game record has an invalid move '" + std::to_string(cellNumber) + "'.");
+        }
+
+        board->markCellByNumber(cellNumber, board->playerTurn()->number());
+        board->togglePlayerTurn();
+    }
+
+    return board;
+}
+
+void GameRecordFile::appendGame(std::string& bytes, Board const& board) {
+    const std::vector<std::shared_ptr<Player>>& players = board.players();
+    const size_t totalMoves = board.totalMarkedCells();
+    const int firstPlayerNumber = totalMoves > 0 
+        ? board.cellPlayerNumber(board.markedCellNumber(0))
+        : board.playerTurn() != nullptr ? board.playerTurn()->number() : 1;
+
+    bytes += static_cast<char>(dynamic_cast<const FrenzyBoard*>(&board) != nullptr ? 1 : 0);
+    GameRecordFile::appendVarint(bytes, board.gridSize());
+    GameRecordFile::appendVarint(bytes, players.size());
+
+    for (const std::shared_ptr<Player>& player : players) {
+        GameRecordFile::appendVarint(bytes, player->marker().size());
+        bytes += player->marker();
+        bytes += static_cast<char>(dynamic_cast<const Bot*>(player.get()) != nullptr ? 1 : 0);
+    }
+
+    GameRecordFile::appendVarint(bytes, firstPlayerNumber);
+    GameRecordFile::appendVarint(bytes, totalMoves);
+
+    for (size_t i = 0; i < totalMoves; i++) {
+        GameRecordFile::appendVarint(bytes, board.markedCellNumber(i));
+    }
+}
+
+GameRecord GameRecordFile::readGame(const uint8_t* bytes, size_t end, size_t position) {
+    const std::function<uint64_t(uint64_t, uint64_t)> readNumber = 
+        [&bytes, &end, &position](uint64_t minValue, uint64_t maxValue) {
+        const uint64_t value = GameRecordFile::readVarint(bytes, end, position);
+        if (value < minValue || value > maxValue) throw std::runtime_error("Game record has an invalid value.");
+
+        return value;
+    };
+    GameRecord record {};
+
+    if (position >= end) throw std::runtime_error("Game record is cut short.");
+    record.isFrenzy = bytes[position++] == 1;
+    //Every cell number has to fit into an int.
+    record.gridSize = readNumber(3, static_cast<uint64_t>(std::sqrt(std::numeric_limits<int>::max())));
+    //Each cell stores the player number within a single byte.
+    const size_t totalPlayers = readNumber(2, std::numeric_limits<uint8_t>::max());
+
+    for (size_t i = 0; i < totalPlayers; i++) {
+        const size_t markerLength = readNumber(1, end);
+        if (markerLength > end - position) throw std::runtime_error("Game record is cut short.");
+
+        record.markers.emplace_back(reinterpret_cast<const char*>(bytes + position), markerLength);
+        position += markerLength;
+        if (position >= end) throw std::runtime_error("Game record is cut short.");
+        record.isBots.push_back(bytes[position++] == 1);
+    }
+
+    record.firstPlayerNumber = readNumber(1, totalPlayers);
+    const size_t totalMoves = readNumber(0, static_cast<uint64_t>(record.gridSize) * record.gridSize);
+
+    record.cellNumbers.reserve(totalMoves);
+
+    for (size_t i = 0; i < totalMoves; i++) {
+        record.cellNumbers.push_back(readNumber(0, static_cast<uint64_t>(record.gridSize) * record.gridSize - 1));
+    }
+
+    return record;
+}
+
+void GameRecordFile::appendVarint(std::string& bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+
+    bytes += static_cast<char>(value);
+}
+
+uint64_t GameRecordFile::readVarint(const uint8_t* bytes, size_t size, size_t& position) {
+    uint64_t value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (position >= size) throw std::runtime_error("Game record is cut short.");
+
+        const uint8_t byte = bytes[position++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) return value;
+    }
+
+    throw std::runtime_error("Game record has a malformed number.");
+}
+
+GameRecordWriter::GameRecordWriter(std::string const& path) {
+    std::ifstream existingFile(path, std::ios::binary);
+    const bool isEmpty = !existingFile || existingFile.peek() == std::ifstream::traits_type::eof();
+
+    if (!isEmpty) {
+        char header[GameRecordFile::HEADER_SIZE] {};
+
+        if (!existingFile.read(header, sizeof(header))
+            || std::memcmp(header, GameRecordFile::MAGIC, sizeof(header) - 1) != 0
+            || static_cast<uint8_t>(header[sizeof(header) - 1]) != GameRecordFile::VERSION) {
+            throw std::runtime_error("'" + path + "' isn't a supported game record.");
+        }
+    }
+
+    this->_file.open(path, std::ios::binary | std::ios::app);
+    if (!this->_file) throw std::runtime_error("Can't open game record '" + path + "'.");
+
+    if (isEmpty) {
+        this->_file.write(GameRecordFile::MAGIC, GameRecordFile::HEADER_SIZE - 1);
+        this->_file.put(static_cast<char>(GameRecordFile::VERSION));
+        this->flush();
+    }
+}
+
+void GameRecordWriter::write(Board const& board) {
+    const std::lock_guard<std::mutex> lock(this->_mutex);
+
+    this->_game.clear();
+    GameRecordFile::appendGame(this->_game, board);
+    this->_writeEncoded(this->_game);
+}
+
+void GameRecordWriter::writeEncoded(std::string_view game) {
+    const std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_writeEncoded(game);
+}
+
+void GameRecordWriter::flush() {
+    this->_file.flush();
+    if (!this->_file) throw std::runtime_error("Can't write game record.");
+}
+
+void GameRecordWriter::_writeEncoded(std::string_view game) {
+    this->_gameLength.clear();
+    GameRecordFile::appendVarint(this->_gameLength, game.size());
+    this->_file.write(this->_gameLength.data(), this->_gameLength.size());
+    this->_file.write(game.data(), game.size());
+
+    if (!this->_file) throw std::runtime_error("Can't write game record.");
+}
+
+GameRecordReader::GameRecordReader(std::string const& path) {
+#if defined(__unix__) || defined(__APPLE__)
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) throw std::runtime_error("Can't open game record '" + path + "'.");
+
+    struct stat fileStatus {};
+
+    if (::fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0) {
+        void* data = ::mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (data != MAP_FAILED) {
+            this->_data = static_cast<const uint8_t*>(data);
+            this->_size = fileStatus.st_size;
+            this->_isMapped = true;
+        }
+    }
+
+    ::close(file);
+#endif
+
+    if (!this->_isMapped) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Can't open game record '" + path + "'.");
+
+        this->_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        this->_data = this->_buffer.data();
+        this->_size = this->_buffer.size();
+    }
+
+    try {
+        if (this->_size < GameRecordFile::HEADER_SIZE
+            || std::memcmp(this->_data, GameRecordFile::MAGIC, GameRecordFile::HEADER_SIZE - 1) != 0
+            || this->_data[GameRecordFile::HEADER_SIZE - 1] != GameRecordFile::VERSION) {
+            throw std::runtime_error("'" + path + "' isn't a supported game record.");
+        }
+
+        //Only lengths are read to index the games, the games themselves are decoded once they're read.
+        size_t position = GameRecordFile::HEADER_SIZE;
+
+        while (position < this->_size) {
+            const uint64_t gameLength = GameRecordFile::readVarint(this->_data, this->_size, position);
+            if (gameLength > this->_size - position) throw std::runtime_error("Game record is cut short.");
+
+            this->_gameOffsets.push_back(position);
+            position += gameLength;
+        }
+
+        this->_gameOffsets.push_back(position);
+
+    } catch (...) {
+        this->_unmap();
+        throw;
+    }
+}
+
+GameRecordReader::~GameRecordReader() { this->_unmap(); }
+
+size_t GameRecordReader::size() const { return this->_gameOffsets.size() - 1; }
+
+GameRecord GameRecordReader::read(size_t gameIndex) const {
+    if (gameIndex >= this->size()) {
+        throw std::runtime_error(
+            "Game record only has " + std::to_string(this->size()) + " games, can't read game " 
+            + std::to_string(gameIndex) + ".");
+    }
+
+    return GameRecordFile::readGame(this->_data, this->_gameOffsets[gameIndex + 1], this->_gameOffsets[gameIndex]);
+}
+
+void GameRecordReader::_unmap() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->_isMapped) ::munmap(const_cast<uint8_t*>(this->_data), this->_size);
+#endif
+    this->_isMapped = false;
+}
+
+size_t PositionBatch::size() const { return this->scores.size() / std::max(1, this->totalPlayers); }
+
+void PositionBatch::clear(int gridSize, int totalPlayers) {
+    this->gridSize = gridSize;
+    this->totalPlayers = totalPlayers;
+    this->planes.clear();
+    this->scores.clear();
+}
+
+void PositionBatch::append(Board const& board, int playerNumber) {
+    const int totalCells = this->gridSize * this->gridSize;
+    const size_t firstPlane = this->planes.size();
+    this->planes.resize(firstPlane + static_cast<size_t>(this->totalPlayers) * totalCells, 0);
+
+    for (int plane = 0; plane < this->totalPlayers; plane++) {
+        this->scores.push_back(board.score((playerNumber - 1 + plane) % this->totalPlayers + 1));
+    }
+
+    //Only marked cells are written, the rest are already zero.
+    for (size_t i = 0; i < board.totalMarkedCells(); i++) {
+        const int cellNumber = board.markedCellNumber(i);
+        const int plane = (board.cellPlayerNumber(cellNumber) - playerNumber + this->totalPlayers) % this->totalPlayers;
+
+        this->planes[firstPlane + static_cast<size_t>(plane) * totalCells + cellNumber] = 1;
+    }
+}
+
+std::string LineBatchEvaluator::name() const { return "lines"; }
+
+void LineBatchEvaluator::evaluate(PositionBatch const& batch, std::vector<float>& values) const {
+    //Step toward the next cell of a line along each axis.
+    static constexpr int AXIS_STEPS[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, -1 } };
+    const int size = batch.gridSize;
+    const size_t totalCells = static_cast<size_t>(size) * size;
+    //Value of lines that only one player has marked, by their plane.
+    std::vector<float> playerLines(batch.totalPlayers, 0.0F);
+    values.assign(batch.size(), 0.0F);
+
+    for (size_t position = 0; position < batch.size(); position++) {
+        const uint8_t* planes = &batch.planes[position * batch.totalPlayers * totalCells];
+        const int* scores = &batch.scores[position * batch.totalPlayers];
+        std::fill(playerLines.begin(), playerLines.end(), 0.0F);
+
+        for (const int* step : AXIS_STEPS) {
+            //Lines starting from each cell, as long as the whole line fits the grid.
+            const int firstColumn = step[1] < 0 ? 2 : 0;
+            const int lastColumn = step[1] > 0 ? size - 2 : size;
+
+            for (int row = 0; row + 2 * step[0] < size; row++) {
+                for (int column = firstColumn; column < lastColumn; column++) {
+                    const size_t first = static_cast<size_t>(row) * size + column;
+                    const size_t second = static_cast<size_t>(row + step[0]) * size + column + step[1];
+                    const size_t third = static_cast<size_t>(row + 2 * step[0]) * size + column + 2 * step[1];
+                    //Either the only player who marked the line, -1 when nobody did, or -2 when many did.
+                    int owner = -1;
+                    int totalOwned = 0;
+
+                    for (int player = 0; player < batch.totalPlayers && owner != -2; player++) {
+                        const uint8_t* plane = &planes[player * totalCells];
+                        const int marked = plane[first] + plane[second] + plane[third];
+
+                        if (marked == 0) continue;
+
+                        owner = owner == -1 ? player : -2;
+                        totalOwned = marked;
+                    }
+
+                    if (owner >= 0) playerLines[owner] += totalOwned * totalOwned;
+                }
+            }
+        }
+
+        int bestOtherScore = 0;
+        float bestOtherLines = 0.0F;
+
+        for (int player = 1; player < batch.totalPlayers; player++) {
+            bestOtherScore = std::max(bestOtherScore, scores[player]);
+            bestOtherLines = std::max(bestOtherLines, playerLines[player]);
+        }
+
+        values[position] = (scores[0] - bestOtherScore) * 100.0F + playerLines[0] - bestOtherLines;
+    }
+}
+
+Simulation::Simulation(SimulationOptions options, std::shared_ptr<GameRecordWriter> recordWriter) : 
+    _options(options),
+    _recordWriter(recordWriter) {
+    this->_result.totalWins.resize(options.totalBots, 0);
+    this->_result.scoreCounts.resize(options.totalBots);
+}
+
+void Simulation::run() {
+    const int totalJobs = static_cast<int>(std::min<long>(this->_options.totalJobs, this->_options.totalGames));
+    std::vector<Table> tables {};
+
+    for (int i = 0; i < totalJobs; i++) tables.push_back(this->_createTable());
+
+    //Deal games in batches, several per thread so the ones finishing early can steal the rest.
+    //Unless they're evaluated in batches, which are better off as big as they're allowed to.
+    long totalBatches = this->_options.batchEvaluator == nullptr
+        ? std::min<long>(this->_options.totalGames, totalJobs * 16L)
+        : std::max<long>(totalJobs, (this->_options.totalGames + this->_options.batchSize - 1) / this->_options.batchSize);
+
+    if (this->_recordWriter != nullptr && this->_options.batchEvaluator == nullptr) {
+        totalBatches = std::max(totalBatches, 
+            (this->_options.totalGames + Simulation::RECORDED_BATCH_GAMES - 1) / Simulation::RECORDED_BATCH_GAMES);
+    }
+
+    ThreadPool threadPool(totalJobs);
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    const uint64_t startAllocations = AllocationCounter::total();
+
+    //Each task takes the next batch in order instead of its own, so the batch holding the next game 
+    //to be written has always started, and the thread playing it never waits on the others.
+    std::atomic<long> nextBatch { 0 };
+
+    threadPool.run(static_cast<int>(totalBatches), [this, &tables, &totalBatches, &nextBatch](int, int threadIndex) {
+        const long batchIndex = nextBatch.fetch_add(1, std::memory_order_relaxed);
+        const long firstGame = this->_options.totalGames * batchIndex / totalBatches;
+        const long lastGame = this->_options.totalGames * (batchIndex + 1) / totalBatches;
+
+        if (this->_options.batchEvaluator == nullptr) this->_playGames(tables.at(threadIndex), firstGame, lastGame);
+        else this->_playBatchedGames(tables.at(threadIndex), firstGame, lastGame);
+    });
+
+    this->_elapsedTime = std::chrono::steady_clock::now() - startTime;
+    this->_totalAllocations = AllocationCounter::total() - startAllocations;
+
+    if (this->_recordWriter != nullptr) this->_recordWriter->flush();
+
+    for (const Table& table : tables) {
+        this->_result.totalDraws += table.result.totalDraws;
+
+        for (int i = 0; i < this->_options.totalBots; i++) {
+            this->_result.totalWins.at(i) += table.result.totalWins.at(i);
+
+            for (const std::pair<const int, long>& scoreCount : table.result.scoreCounts.at(i)) {
+                this->_result.scoreCounts.at(i)[scoreCount.first] += scoreCount.second;
+            }
+        }
+    }
+}
+
+Simulation::Table Simulation::_createTable() const {
+    Table table {};
+    table.screen = std::make_shared<Screen>();
+    table.result.totalWins.resize(this->_options.totalBots, 0);
+    table.result.scoreCounts.resize(this->_options.totalBots);
+
+    for (int number = 1; number <= this->_options.totalBots; number++) {
+        //Markers are never rendered, they only need to be a single character.
+        const std::string marker(1, static_cast<char>('!' + (number - 1) % ('~' - '!' + 1)));
+        SearchOptions searchOptions = this->_options.searchOptions;
+
+        if (!this->_options.evaluators.empty()) {
+            searchOptions.evaluator = this->_options.evaluators.at((number - 1) % this->_options.evaluators.size());
+        }
+
+        table.bots.push_back(std::make_shared<Bot>(number, marker, searchOptions));
+
+        if (this->_options.batchEvaluator != nullptr) {
+            table.candidateEvaluators.push_back(searchOptions.evaluator != nullptr 
+                ? searchOptions.evaluator
+                : std::make_shared<const ChainEvaluator>());
+        }
+    }
+
+    if (this->_options.isFrenzy) {
+        table.screen->setBoard(std::make_unique<FrenzyBoard>(table.screen, table.bots, this->_options.gridSize));
+    } else {
+        table.screen->setBoard(ClassicBoard::create(table.screen, table.bots));
+    }
+
+    //Solved before the clock starts, instead of during the first game.
+    if (!this->_options.isFrenzy && this->_options.totalBots == 2 && this->_options.searchOptions.isSolvedBookUsed) {
+        OpeningBook::solvedClassic();
+    }
+
+    if (this->_options.batchEvaluator != nullptr) {
+        const long totalBatchGames = std::min<long>(this->_options.batchSize, this->_options.totalGames);
+
+        for (long i = 0; i < totalBatchGames; i++) table.batchBoards.push_back(table.screen->board()->clone());
+    }
+
+    return table;
+}
+
+void Simulation::_playGames(Table& table, long firstGame, long lastGame) const {
+    const std::unique_ptr<Board>& board = table.screen->board();
+    const std::optional<uint64_t>& seed = this->_options.searchOptions.seed;
+
+    for (long game = firstGame; game < lastGame; game++) {
+        if (seed.has_value()) board->seed(*seed + game);
+
+        board->reset();
+        board->togglePlayerTurn();
+
+        while (!board->isCompleted()) {
+            const std::shared_ptr<Player>& player = board->playerTurn();
+            const int cellNumber = player->requireCellSelection(*board);
+            INSTRUMENT(const Instrumentation::TurnScope turnScope {};)
+
+            board->markCellByNumber(cellNumber, player->number());
+            board->togglePlayerTurn();
+        }
+
+        this->_recordGame(table, *board, game);
+    }
+}
+
+void Simulation::_playBatchedGames(Table& table, long firstGame, long lastGame) const {
+    const std::optional<uint64_t>& seed = this->_options.searchOptions.seed;
+    const size_t candidateLimit = std::max(1, this->_options.searchOptions.candidateLimit);
+    const long totalGames = lastGame - firstGame;
+    std::vector<Board*> boards {};
+    //Candidates of every game within the round, where each game owns a range of them.
+    std::vector<int> candidateCells {};
+    std::vector<size_t> firstCandidates {};
+    std::vector<ConnectedCell> rankedCells {};
+    std::vector<ConnectedCell> nextPlayerCells {};
+    std::vector<int> availableCells {};
+    PositionBatch batch {};
+    std::vector<float> values {};
+
+    for (long game = firstGame; game < lastGame; game++) {
+        const std::unique_ptr<Board>& board = table.batchBoards.at(game - firstGame);
+        if (seed.has_value()) board->seed(*seed + game);
+
+        board->reset();
+        board->togglePlayerTurn();
+        boards.push_back(board.get());
+    }
+
+    while (!boards.empty()) {
+        candidateCells.clear();
+        firstCandidates.clear();
+        batch.clear(boards.at(0)->gridSize(), boards.at(0)->players().size());
+
+        for (Board* board : boards) {
+            const int playerNumber = board->playerTurn()->number();
+            const int nextPlayerNumber = playerNumber % board->players().size() + 1;
+            const Evaluator& candidateEvaluator = *table.candidateEvaluators.at(playerNumber - 1);
+            firstCandidates.push_back(candidateCells.size());
+
+            //Cells to chain alternated with cells to block the next player, as bots look ahead.
+            board->readAvailableCellNumbers(availableCells);
+            candidateEvaluator.rankCells(*board, playerNumber, availableCells, rankedCells);
+            candidateEvaluator.rankCells(*board, nextPlayerNumber, availableCells, nextPlayerCells);
+
+            for (size_t i = 0; i < rankedCells.size() && i < candidateLimit; i++) {
+                const ConnectedCell* cells[] = { &rankedCells.at(i), &nextPlayerCells.at(i) };
+
+                for (const ConnectedCell* cell : cells) {
+                    const int cellNumber = board->cellNumberByPosition(cell->row, cell->column);
+
+                    if (std::find(candidateCells.begin() + firstCandidates.back(), candidateCells.end(), cellNumber) 
+                        == candidateCells.end()) {
+                        candidateCells.push_back(cellNumber);
+                        board->applyMove(cellNumber, playerNumber);
+                        batch.append(*board, playerNumber);
+                        board->undoMove();
+                    }
+                }
+            }
+        }
+
+        firstCandidates.push_back(candidateCells.size());
+        this->_options.batchEvaluator->evaluate(batch, values);
+
+        for (size_t i = 0; i < boards.size(); i++) {
+            Board& board = *boards.at(i);
+            size_t bestCandidate = firstCandidates.at(i);
+
+            //Ties go to the highest ranked candidate.
+            for (size_t candidate = firstCandidates.at(i); candidate < firstCandidates.at(i + 1); candidate++) {
+                if (values.at(candidate) > values.at(bestCandidate)) bestCandidate = candidate;
+            }
+
+            INSTRUMENT(const Instrumentation::TurnScope turnScope {};)
+            board.markCellByNumber(candidateCells.at(bestCandidate), board.playerTurn()->number());
+            board.togglePlayerTurn();
+        }
+
+        boards.erase(
+            std::remove_if(boards.begin(), boards.end(), [](Board* board) { return board->isCompleted(); }), 
+            boards.end());
+    }
+
+    for (long game = 0; game < totalGames; game++) {
+        this->_recordGame(table, *table.batchBoards.at(game), firstGame + game);
+    }
+}
+
+void Simulation::_recordGame(Table& table, Board const& board, long game) const {
+    if (this->_recordWriter != nullptr) {
+        table.recordedGame.clear();
+        GameRecordFile::appendGame(table.recordedGame, board);
+
+        std::unique_lock<std::mutex> lock(this->_recordMutex);
+        this->_recordCondition.wait(lock, [this, game]() {
+            return game == this->_nextRecordedGame 
+                || this->_pendingRecordedGames.size() < Simulation::MAX_PENDING_RECORDED_GAMES;
+        });
+
+        if (game != this->_nextRecordedGame) {
+            this->_pendingRecordedGames.emplace(game, table.recordedGame);
+        } else {
+            this->_recordWriter->writeEncoded(table.recordedGame);
+            this->_nextRecordedGame++;
+
+            //Followed by the games that were only waiting on this one.
+            for (std::map<long, std::string>::iterator pendingGame = this->_pendingRecordedGames.begin();
+                pendingGame != this->_pendingRecordedGames.end() && pendingGame->first == this->_nextRecordedGame;
+                pendingGame = this->_pendingRecordedGames.erase(pendingGame)) {
+                this->_recordWriter->writeEncoded(pendingGame->second);
+                this->_nextRecordedGame++;
+            }
+
+            this->_recordCondition.notify_all();
+        }
+    }
+
+    const std::shared_ptr<Player> winner = board.winner();
+
+    if (winner == nullptr) table.result.totalDraws++;
+    else table.result.totalWins.at(winner->number() - 1)++;
+
+    for (const std::shared_ptr<Player>& bot : table.bots) {
+        table.result.scoreCounts.at(bot->number() - 1)[board.score(bot->number())]++;
+    }
+}
+
+std::string Simulation::summaryText() const {
+    const long totalGames = this->_options.totalGames;
+    const double seconds = std::chrono::duration<double>(this->_elapsedTime).count();
+    const std::function<double(long)> percentage = [&totalGames](long count) {
+        return totalGames == 0 ? 0.0 : count * 100.0 / totalGames;
+    };
+    std::ostringstream text;
+
+    text << std::fixed << std::setprecision(1)
+        << "Simulated " << totalGames << " " << (this->_options.isFrenzy ? "Frenzy" : "Classic") 
+        << " games with " << this->_options.totalBots << " bots on " 
+        << std::min<long>(this->_options.totalJobs, totalGames) << " threads in " << seconds << "s ("
+        << (seconds > 0 ? totalGames / seconds : 0.0) << " games/s).\n";
+
+    if (this->_options.batchEvaluator != nullptr) {
+        text << "Evaluated by '" << this->_options.batchEvaluator->name() << "' in batches of up to " 
+            << this->_options.batchSize << " games per thread.\n";
+    }
+
+    if (AllocationCounter::isCounting()) {
+        text
+            << "Heap allocations while playing: " << this->_totalAllocations << " (" << std::setprecision(3)
+            << (totalGames == 0 ? 0.0 : static_cast<double>(this->_totalAllocations) / totalGames) 
+            << std::setprecision(1) << " per game).\n";
+    }
+
+    text << "\n"
+        << "Draws: " << this->_result.totalDraws << " (" << percentage(this->_result.totalDraws) << "%)\n";
+
+    for (int i = 0; i < this->_options.totalBots; i++) {
+        const std::map<int, long>& scoreCounts = this->_result.scoreCounts.at(i);
+        long totalScore = 0;
+        long countedGames = 0;
+        int medianScore = 0;
+
+        for (const std::pair<const int, long>& scoreCount : scoreCounts) {
+            totalScore += scoreCount.first * scoreCount.second;
+        }
+
+        for (const std::pair<const int, long>& scoreCount : scoreCounts) {
+            countedGames += scoreCount.second;
+            medianScore = scoreCount.first;
+
+            if (countedGames * 2 >= totalGames) break;
+        }
+
+        text << "Bot-" << i + 1;
+
+        if (!this->_options.evaluators.empty()) {
+            text << " (" << this->_options.evaluators.at(i % this->_options.evaluators.size())->name() << ")";
+        }
+
+        text << ": " << this->_result.totalWins.at(i) << " wins (" 
+            << percentage(this->_result.totalWins.at(i)) << "%), score ";
+
+        if (scoreCounts.empty()) {
+            text << "-\n";
+            continue;
+        }
+
+        text << "min " << scoreCounts.begin()->first 
+            << ", median " << medianScore
+            << ", mean " << (totalGames == 0 ? 0.0 : static_cast<double>(totalScore) / totalGames)
+            << ", max " << scoreCounts.rbegin()->first << "\n";
+    }
+
+    return text.str();
+}
+
+}
+
+#if defined(TIC_TAC_TOE_ALLOCATION_COUNTER)
+//Global, so they're outside of the namespace.
+//Every other version forwards into these two pairs, so each allocation is counted exactly once.
+//Kept out of line, otherwise GCC sees the malloc and free through them and warns they don't match.
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    tic_tac_toe::AllocationCounter::count();
+
+    void* memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) throw std::bad_alloc();
+
+    return memory;
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+
+//Over-allocated by malloc and aligned within, keeping the original pointer right before the aligned one.
+//As `std::aligned_alloc` isn't available everywhere and has to be freed differently on some platforms.
+[[gnu::noinline]] void* operator new(std::size_t size, std::align_val_t alignment) {
+    tic_tac_toe::AllocationCounter::count();
+
+    const size_t bytes = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    void* memory = std::malloc(size + bytes + sizeof(void*));
+    if (memory == nullptr) throw std::bad_alloc();
+
+    const uintptr_t aligned = (reinterpret_cast<uintptr_t>(memory) + sizeof(void*) + bytes - 1) & ~(bytes - 1);
+    reinterpret_cast<void**>(aligned)[-1] = memory;
+    return reinterpret_cast<void*>(aligned);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::align_val_t) noexcept { 
+    if (memory != nullptr) std::free(static_cast<void**>(memory)[-1]); 
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (std::bad_alloc const&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) { return ::operator new(size, alignment); }
+
+void* operator new(std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    try {
+        return ::operator new(size, alignment);
+    } catch (std::bad_alloc const&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, std::nothrow_t const&) noexcept {
+    return ::operator new(size, alignment, std::nothrow);
+}
+
+void operator delete[](void* memory) noexcept { ::operator delete(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { ::operator delete(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept { ::operator delete(memory); }
+
+void operator delete(void* memory, std::nothrow_t const&) noexcept { ::operator delete(memory); }
+
+void operator delete[](void* memory, std::nothrow_t const&) noexcept { ::operator delete(memory); }
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept { ::operator delete(memory, alignment); }
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept { 
+    ::operator delete(memory, alignment); 
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept { 
+    ::operator delete(memory, alignment); 
+}
+
+void operator delete(void* memory, std::align_val_t alignment, std::nothrow_t const&) noexcept { 
+    ::operator delete(memory, alignment); 
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, std::nothrow_t const&) noexcept { 
+    ::operator delete(memory, alignment); 
+}
+#endif
+
+#endif